@@ -0,0 +1,261 @@
+#include "alltoall_transport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    // Send buffers start on their own cache lines, clear of the barrier
+    constexpr size_t SLOT_ALIGNMENT = 64;
+
+    atomic<unsigned int> shm_sequence{0};
+
+    runtime_error errno_error(const string& what)
+    {
+        return runtime_error(what + ": " + strerror(errno));
+    }
+}
+
+struct shm_transport::control
+{
+    pthread_barrier_t barrier;
+};
+
+unique_ptr<alltoall_transport> alltoall_transport::create(transport_kind kind, unsigned int ranks, size_t block)
+{
+    if (kind == transport_kind::socket)
+    {
+        return make_unique<socket_transport>(ranks, block);
+    }
+    return make_unique<shm_transport>(ranks, block);
+}
+
+const char* alltoall_transport::kind_name(transport_kind kind)
+{
+    return kind == transport_kind::socket ? "socket" : "shm";
+}
+
+bool alltoall_transport::parse_kind(const string& name, transport_kind& kind)
+{
+    if (name == "shm") kind = transport_kind::shared_memory;
+    else if (name == "socket") kind = transport_kind::socket;
+    else return false;
+    return true;
+}
+
+shm_transport::shm_transport(unsigned int ranks, size_t block) : alltoall_transport(ranks, block)
+{
+    const size_t header_bytes = (sizeof(control) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+    mapped_bytes = header_bytes + size_t(ranks) * ranks * block * sizeof(complex<double>);
+
+    // The name is only needed until the mapping exists: unlinked right away, the object
+    // lives on in this process's mapping and in every child forked from it
+    const string name = "/fft_alltoall_" + to_string(getpid()) + "_" + to_string(shm_sequence++);
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        throw errno_error("shm_transport: cannot create " + name);
+    }
+    shm_unlink(name.c_str());
+    if (ftruncate(fd, off_t(mapped_bytes)) != 0)
+    {
+        const runtime_error error = errno_error("shm_transport: cannot size " + name);
+        close(fd);
+        throw error;
+    }
+    void* base = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw errno_error("shm_transport: cannot map " + to_string(mapped_bytes) + " bytes");
+    }
+
+    header = static_cast<control*>(base);
+    slots = reinterpret_cast<complex<double>*>(static_cast<char*>(base) + header_bytes);
+
+    pthread_barrierattr_t attributes;
+    pthread_barrierattr_init(&attributes);
+    pthread_barrierattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&header->barrier, &attributes, ranks);
+    pthread_barrierattr_destroy(&attributes);
+}
+
+shm_transport::~shm_transport()
+{
+    // The barrier is not destroyed: glibc waits there for every waiter to leave, which a
+    // killed rank never does, and a process-shared barrier needs nothing beyond the unmap
+    if (header == nullptr) return;
+    munmap(header, mapped_bytes);
+}
+
+complex<double>* shm_transport::send_buffer(unsigned int rank)
+{
+    return slots + size_t(rank) * num_ranks * block;
+}
+
+void shm_transport::exchange(unsigned int rank, complex<double>* recv)
+{
+    // Every send buffer is complete
+    pthread_barrier_wait(&header->barrier);
+    for (unsigned int source = 0; source < num_ranks; ++source)
+    {
+        const complex<double>* from = send_buffer(source) + size_t(rank) * block;
+        std::copy(from, from + block, recv + size_t(source) * block);
+    }
+    // Nobody reads any send buffer any more
+    pthread_barrier_wait(&header->barrier);
+}
+
+socket_transport::socket_transport(unsigned int ranks, size_t block)
+    : alltoall_transport(ranks, block), peers(size_t(ranks) * ranks, -1)
+{
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        throw errno_error("socket_transport: cannot create a socket");
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, int(ranks)) != 0 ||
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        const runtime_error error = errno_error("socket_transport: cannot listen on 127.0.0.1");
+        close(listener);
+        throw error;
+    }
+
+    // Connect each pair in turn: i dials, the listener hands j its end
+    for (unsigned int i = 0; i < ranks; ++i)
+    {
+        for (unsigned int j = i + 1; j < ranks; ++j)
+        {
+            const int dialer = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (dialer < 0 || connect(dialer, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                const runtime_error error = errno_error("socket_transport: cannot connect over 127.0.0.1");
+                if (dialer >= 0) close(dialer);
+                close(listener);
+                throw error;
+            }
+            const int accepted = accept(listener, nullptr, nullptr);
+            if (accepted < 0)
+            {
+                const runtime_error error = errno_error("socket_transport: cannot accept a connection");
+                close(dialer);
+                close(listener);
+                throw error;
+            }
+            for (int fd : {dialer, accepted})
+            {
+                const int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            }
+            peers[size_t(i) * ranks + j] = dialer;
+            peers[size_t(j) * ranks + i] = accepted;
+        }
+    }
+    close(listener);
+}
+
+socket_transport::~socket_transport()
+{
+    for (int fd : peers)
+    {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void socket_transport::keep_rank(unsigned int rank)
+{
+    for (size_t i = 0; i < peers.size(); ++i)
+    {
+        if (i / num_ranks != rank && peers[i] >= 0)
+        {
+            close(peers[i]);
+            peers[i] = -1;
+        }
+    }
+}
+
+complex<double>* socket_transport::send_buffer(unsigned int)
+{
+    if (outgoing.empty())
+    {
+        outgoing.resize(size_t(num_ranks) * block);
+    }
+    return outgoing.data();
+}
+
+void socket_transport::exchange(unsigned int rank, complex<double>* recv)
+{
+    const complex<double>* send = send_buffer(rank);
+    std::copy(send + size_t(rank) * block, send + size_t(rank + 1) * block, recv + size_t(rank) * block);
+
+    const size_t block_bytes = block * sizeof(complex<double>);
+    for (unsigned int round = 1; round < num_ranks; ++round)
+    {
+        const unsigned int target = (rank + round) % num_ranks;
+        const unsigned int source = (rank + num_ranks - round) % num_ranks;
+        const char* out = reinterpret_cast<const char*>(send + size_t(target) * block);
+        char* in = reinterpret_cast<char*>(recv + size_t(source) * block);
+        size_t sent = 0;
+        size_t received = 0;
+
+        pollfd fds[2];
+        fds[0].fd = peers[size_t(rank) * num_ranks + target];
+        fds[1].fd = peers[size_t(rank) * num_ranks + source];
+        while (sent < block_bytes || received < block_bytes)
+        {
+            fds[0].events = sent < block_bytes ? POLLOUT : 0;
+            fds[1].events = received < block_bytes ? POLLIN : 0;
+            fds[0].revents = 0;
+            fds[1].revents = 0;
+            // With two ranks target and source are one socket; poll takes both entries as they are
+            if (poll(fds, 2, -1) < 0)
+            {
+                if (errno == EINTR) continue;
+                throw errno_error("socket_transport: poll failed");
+            }
+            if (sent < block_bytes && (fds[0].revents & (POLLOUT | POLLERR | POLLHUP)))
+            {
+                const ssize_t count = ::send(fds[0].fd, out + sent, block_bytes - sent, MSG_NOSIGNAL);
+                if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    throw errno_error("socket_transport: send to rank " + to_string(target) + " failed");
+                }
+                if (count > 0) sent += size_t(count);
+            }
+            if (received < block_bytes && (fds[1].revents & (POLLIN | POLLERR | POLLHUP)))
+            {
+                const ssize_t count = ::recv(fds[1].fd, in + received, block_bytes - received, 0);
+                if (count == 0)
+                {
+                    throw runtime_error("socket_transport: rank " + to_string(source) + " closed its connection");
+                }
+                if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    throw errno_error("socket_transport: receive from rank " + to_string(source) + " failed");
+                }
+                if (count > 0) received += size_t(count);
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum class transport_kind
+{
+    shared_memory, // POSIX shm mailbox, one copy per block
+    socket         // localhost TCP, one connection per pair of ranks; stands in for a network
+};
+
+// All-to-all personalized exchange between the `ranks` processes of a distributed transform.
+// Rank r fills send_buffer(r) with `ranks` blocks of `block` elements, block j meant for
+// rank j, then calls exchange(r, recv); on return recv block i holds what rank i put in its
+// block r. Every rank calls exchange() the same number of times, and the send buffer may be
+// refilled as soon as exchange() returns. The transport is created before the workers are
+// forked, so every rank inherits its shared mapping or its connections; each process then
+// calls keep_rank() to drop what belongs to the others.
+class alltoall_transport {
+public:
+    virtual ~alltoall_transport() = default;
+
+    virtual complex<double>* send_buffer(unsigned int rank) = 0;
+    virtual void exchange(unsigned int rank, complex<double>* recv) = 0;
+    // Called after the fork by the process running `rank`, and by the parent with ranks()
+    // to keep none. Nothing to release by default.
+    virtual void keep_rank(unsigned int) {}
+
+    unsigned int ranks() const { return num_ranks; }
+    size_t block_size() const { return block; }
+
+    // Throws runtime_error when the shared memory or the connections cannot be set up
+    static unique_ptr<alltoall_transport> create(transport_kind kind, unsigned int ranks, size_t block);
+
+    static const char* kind_name(transport_kind kind);
+    // Accepts shm|socket; returns false for anything else
+    static bool parse_kind(const string& name, transport_kind& kind);
+
+protected:
+    alltoall_transport(unsigned int ranks, size_t block_elements) : num_ranks(ranks), block(block_elements) {}
+
+    unsigned int num_ranks;
+    size_t block;
+};
+
+// Every rank's send buffer lives in one POSIX shared-memory object; after a barrier each
+// rank copies its block straight out of the others' buffers, and a second barrier keeps a
+// rank from refilling its buffer while the others still read it.
+class shm_transport : public alltoall_transport {
+public:
+    shm_transport(unsigned int ranks, size_t block);
+    ~shm_transport() override;
+
+    complex<double>* send_buffer(unsigned int rank) override;
+    void exchange(unsigned int rank, complex<double>* recv) override;
+
+private:
+    struct control;
+
+    control* header = nullptr;
+    complex<double>* slots = nullptr;
+    size_t mapped_bytes = 0;
+};
+
+// One TCP connection over 127.0.0.1 per pair of ranks, made before the fork. In round s
+// rank r sends its block to r + s and receives from r - s (mod ranks), both sides polled
+// together on non-blocking sockets so no pair can deadlock on full socket buffers.
+class socket_transport : public alltoall_transport {
+public:
+    socket_transport(unsigned int ranks, size_t block);
+    ~socket_transport() override;
+
+    complex<double>* send_buffer(unsigned int rank) override;
+    void exchange(unsigned int rank, complex<double>* recv) override;
+    // Closes the other ranks' ends, so a rank that dies shows up as a closed connection
+    void keep_rank(unsigned int rank) override;
+
+private:
+    // peers[i * ranks + j]: rank i's end of its connection to rank j, -1 on the diagonal
+    vector<int> peers;
+    // Private to each process after the fork, so one buffer serves whichever rank it runs
+    vector<complex<double>> outgoing;
+};
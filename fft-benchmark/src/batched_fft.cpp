@@ -0,0 +1,82 @@
+#include "batched_fft.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // Smallest number of lane groups handed to one participant at a time
+    constexpr size_t MIN_GROUPS_PER_TASK = 4;
+}
+
+batched_fft::batched_fft(size_t size, fft_direction direction, simd_isa kernel_isa)
+    : n(size), isa(kernel_isa), width(simd_fft::lanes(kernel_isa)), plan(fft_plan::get(size, direction))
+{
+}
+
+void batched_fft::execute(complex<double>* data, size_t batch, size_t stride, size_t distance,
+                          thread_pool* pool) const
+{
+    const size_t num_groups = (batch + width - 1) / width;
+    auto body = [&](size_t begin, size_t end)
+    {
+        for (size_t group = begin; group < end; ++group)
+        {
+            const size_t first = group * width;
+            transform_group(data, first, std::min<size_t>(width, batch - first), stride, distance);
+        }
+    };
+
+    if (pool == nullptr)
+    {
+        body(0, num_groups);
+        return;
+    }
+    const size_t grain = std::max<size_t>(MIN_GROUPS_PER_TASK, num_groups / (size_t(pool->size()) * 8));
+    pool->parallel_for(num_groups, grain, body);
+}
+
+void batched_fft::transform_group(complex<double>* data, size_t first, size_t count, size_t stride,
+                                  size_t distance) const
+{
+    // Per-thread workspace: N * lanes values each for the real and imaginary parts
+    thread_local vector<double> re;
+    thread_local vector<double> im;
+    re.resize(n * width);
+    im.resize(n * width);
+
+    // 1. Gather in bit-reversed order; idle lanes of a partial group are zeroed
+    const vector<uint32_t>& reversed = plan->bit_reversal();
+    for (size_t lane = 0; lane < width; ++lane)
+    {
+        if (lane >= count)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                re[i * width + lane] = 0.0;
+                im[i * width + lane] = 0.0;
+            }
+            continue;
+        }
+        const complex<double>* frame = data + (first + lane) * distance;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const complex<double> value = frame[size_t(reversed[i]) * stride];
+            re[i * width + lane] = value.real();
+            im[i * width + lane] = value.imag();
+        }
+    }
+
+    // 2. All stages, one vector of frames per butterfly
+    simd_fft::execute_interleaved_stages(re.data(), im.data(), *plan, isa);
+
+    // 3. Scatter back
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+        complex<double>* frame = data + (first + lane) * distance;
+        for (size_t i = 0; i < n; ++i)
+        {
+            frame[i * stride] = {re[i * width + lane], im[i * width + lane]};
+        }
+    }
+}
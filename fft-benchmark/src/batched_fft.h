@@ -0,0 +1,41 @@
+#pragma once
+
+#include "fft_plan.h"
+#include "fft_simd.h"
+#include "thread_pool.h"
+
+#include <complex>
+#include <memory>
+
+using namespace std;
+
+// Many independent power-of-two transforms of the same length in one call.
+// Transform b, element i lives at data[b * distance + i * stride], so a contiguous
+// [batch][N] buffer is stride 1, distance N, and a [N][batch] buffer is stride batch,
+// distance 1. Frames are gathered lanes(isa) at a time into a lane-interleaved split
+// buffer (bit-reversing on the way), transformed together with one vector per
+// butterfly, and scattered back. Groups of frames are spread over the pool.
+class batched_fft {
+public:
+    batched_fft(size_t size, fft_direction direction, simd_isa kernel_isa);
+
+    void execute(complex<double>* data, size_t batch, size_t stride, size_t distance,
+                 thread_pool* pool = nullptr) const;
+
+    // Contiguous [batch][N] buffer
+    void execute(complex<double>* data, size_t batch, thread_pool* pool = nullptr) const
+    {
+        execute(data, batch, 1, n, pool);
+    }
+
+    size_t size() const { return n; }
+    unsigned int lanes() const { return width; }
+
+private:
+    void transform_group(complex<double>* data, size_t first, size_t count, size_t stride, size_t distance) const;
+
+    size_t n;
+    simd_isa isa;
+    unsigned int width;
+    shared_ptr<const fft_plan> plan;
+};
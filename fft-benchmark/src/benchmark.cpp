@@ -1,12 +1,26 @@
 #include "benchmark.h"
+#include "batched_fft.h"
+#include "bit_reversal.h"
+#include "distributed_fft.h"
+#include "fast_convolution.h"
+#include "fft_tuner.h"
+#include "fft_validation.h"
+#include "four_step_fft.h"
+#include "mixed_radix_fft.h"
+#include "multidim_fft.h"
+#include "out_of_core_fft.h"
+#include "real_fft.h"
+#include "stft.h"
 
-#include <barrier>
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <complex>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <random>
-#include <thread>
+#include <stdexcept>
 #include <vector>
 
 
@@ -17,230 +31,2063 @@ const std::vector<int> INPUT_SIZES = {
     33554432
 };
 
+// Non-power-of-two sizes: 7-smooth frame lengths (3000 and 48000 among them) run on the
+// mixed-radix engine, the rest (primes and sizes with large prime factors) on Bluestein
+const std::vector<int> NON_POW2_SIZES = {
+    30, 97, 100, 360, 1000, 1009, 3000, 4800, 10007, 12000, 48000, 65537,
+    100000, 480000, 1000000, 1000003, 3000000, 4800000
+};
+
+// Batch-size x transform-size grid for the many-small-transforms workload
+const std::vector<int> BATCH_FFT_SIZES = {256, 512, 1024, 2048, 4096};
+const std::vector<int> BATCH_SIZES = {1, 8, 64, 512, 4096};
+
+// Filter lengths for the FFT vs direct convolution comparison, over one stream of
+// CONVOLUTION_STREAM_LENGTH samples fed in chunks of CONVOLUTION_CHUNK samples
+const std::vector<int> FILTER_LENGTHS = {2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+const size_t CONVOLUTION_STREAM_LENGTH = 1 << 18;
+const size_t CONVOLUTION_CHUNK = 4096;
+
+// STFT grid: window sizes, overlaps as window / hop (2 is 50%, 4 is 75%) and frames per
+// batched transform, over one stream of STFT_STREAM_LENGTH samples fed in STFT_CHUNK pieces
+const std::vector<int> STFT_WINDOW_SIZES = {1024, 2048, 4096, 8192};
+const std::vector<int> STFT_OVERLAPS = {2, 4};
+const std::vector<int> STFT_BATCH_FRAMES = {1, 8, 32};
+const size_t STFT_STREAM_LENGTH = 1 << 20;
+const size_t STFT_CHUNK = 512;
+
+// 2D and 3D shapes, square and not, up to a few thousand per side
+const std::vector<std::vector<size_t>> MULTIDIM_SHAPES = {
+    {256, 256}, {1024, 1024}, {2048, 2048}, {512, 4096}, {4096, 512}, {64, 8192},
+    {64, 64, 64}, {128, 128, 128}, {32, 256, 256}, {256, 256, 32}
+};
+
+// Thread counts and sizes for the depth-first vs per-stage barrier scaling comparison
+const std::vector<unsigned int> SCALING_THREADS = {1, 2, 4, 8, 16, 32, 64};
+const std::vector<int> SCALING_SIZES = {65536, 262144, 1048576, 4194304, 16777216};
+
+// Distributed transform sizes, each split over the worker processes of every transport
+const std::vector<int> DISTRIBUTED_SIZES = {65536, 262144, 1048576, 4194304, 16777216};
+const transport_kind DISTRIBUTED_TRANSPORTS[] = {transport_kind::shared_memory, transport_kind::socket};
+
+// Smallest chunk of butterflies the pool hands to one participant
+const size_t MIN_BUTTERFLIES_PER_TASK = 2048;
+
+// Depth-first engine: blocks of up to benchmark::DEPTH_FIRST_BLOCK points are transformed to
+// completion by one participant; inside a block the recursion stops at DEPTH_FIRST_LEAF
+// points, which run their stages in a loop
+const size_t DEPTH_FIRST_LEAF = 64;
+// Blocks are halved until every participant gets at least this many
+const size_t DEPTH_FIRST_BLOCKS_PER_THREAD = 4;
+
+namespace
+{
+    // z * exp(-+i*pi/2): the quarter-turn twiddle of a radix-4 butterfly
+    inline complex<double> rotate_quarter(complex<double> z, fft_direction direction)
+    {
+        return direction == fft_direction::forward ? complex<double>(z.imag(), -z.real())
+                                                   : complex<double>(-z.imag(), z.real());
+    }
+
+    // W_m^e for 0 <= e < m, from the stage table with half-span m/2, using W_m^(e + m/2) = -W_m^e
+    inline complex<double> stage_twiddle(const fft_plan& plan, size_t m, size_t e)
+    {
+        const size_t half = m / 2;
+        return e < half ? plan.twiddle(half, e) : -plan.twiddle(half, e - half);
+    }
+
+    // Combines four length-q sub-transforms at data[k], data[k + q], data[k + 2q], data[k + 3q]
+    // (bit-reversed order) into one of length 4q for j in [j_begin, j_end). This is two
+    // radix-2 stages fused, so the block is read and written once instead of twice.
+    inline void radix4_butterflies(complex<double>* data, size_t k, size_t q, size_t j_begin, size_t j_end,
+                                   const fft_plan& plan)
+    {
+        const size_t m = 4 * q;
+        const fft_direction direction = plan.direction();
+        complex<double>* a0 = data + k;
+        complex<double>* a1 = a0 + q;
+        complex<double>* a2 = a1 + q;
+        complex<double>* a3 = a2 + q;
+        for (size_t j = j_begin; j < j_end; ++j)
+        {
+            const complex<double> x0 = a0[j];
+            const complex<double> x1 = plan.twiddle(q, j) * a1[j];   // W_4q^2j
+            const complex<double> x2 = plan.twiddle(2 * q, j) * a2[j]; // W_4q^j
+            const complex<double> x3 = stage_twiddle(plan, m, 3 * j) * a3[j];
+
+            const complex<double> even_sum = x0 + x1;
+            const complex<double> even_diff = x0 - x1;
+            const complex<double> odd_sum = x2 + x3;
+            const complex<double> odd_diff = rotate_quarter(x2 - x3, direction);
+
+            a0[j] = even_sum + odd_sum;
+            a1[j] = even_diff + odd_diff;
+            a2[j] = even_sum - odd_sum;
+            a3[j] = even_diff - odd_diff;
+        }
+    }
+
+    // Butterflies [begin, end) of the radix-2 stage with half-span `half`, numbered
+    // b = group * half + j, so a range can start in the middle of a group
+    template <typename T>
+    inline void butterfly_range(complex<T>* data, size_t half, const T* w_re, const T* w_im, size_t begin,
+                                size_t end)
+    {
+        const size_t m = half * 2;
+        size_t b = begin;
+        while (b < end)
+        {
+            const size_t k = (b / half) * m;
+            const size_t j_begin = b % half;
+            const size_t j_end = std::min(half, j_begin + (end - b));
+            for (size_t j = j_begin; j < j_end; ++j)
+            {
+                complex<T> t = complex<T>(w_re[j], w_im[j]) * data[k + j + half];
+                complex<T> u = data[k + j];
+                data[k + j] = u + t;
+                data[k + j + half] = u - t;
+            }
+            b += j_end - j_begin;
+        }
+    }
+
+    // Radix-2 DIT over a bit-reversed block of n points, depth first: each half is finished
+    // before the stage that joins them, so every level reuses what the level below left in cache
+    void depth_first_block(complex<double>* data, size_t n, const fft_plan& plan)
+    {
+        if (n <= DEPTH_FIRST_LEAF)
+        {
+            for (size_t half = 1; half < n; half <<= 1)
+            {
+                butterfly_range(data, half, plan.stage_twiddles_re(half), plan.stage_twiddles_im(half), 0, n / 2);
+            }
+            return;
+        }
+        depth_first_block(data, n / 2, plan);
+        depth_first_block(data + n / 2, n / 2, plan);
+        butterfly_range(data, n / 2, plan.stage_twiddles_re(n / 2), plan.stage_twiddles_im(n / 2), 0, n / 2);
+    }
+
+    inline void begin_phase(fft_phase_observer* observer, fft_phase phase, unsigned int stage = 0)
+    {
+        if (observer) observer->begin_phase(phase, stage);
+    }
+
+    inline void end_phase(fft_phase_observer* observer)
+    {
+        if (observer) observer->end_phase();
+    }
+
+    // While alive, reports every join of the pool as a barrier phase of the current stage
+    class barrier_reporting {
+    public:
+        barrier_reporting(thread_pool& thread_pool, fft_phase_observer* observer, const unsigned int& stage)
+            : pool(thread_pool), active(observer != nullptr)
+        {
+            if (!active) return;
+            pool.set_join_hook([observer, &stage](bool waiting)
+            {
+                if (waiting) observer->begin_phase(fft_phase::barrier, stage);
+                else observer->end_phase();
+            });
+        }
+        ~barrier_reporting()
+        {
+            if (active) pool.set_join_hook(nullptr);
+        }
+
+    private:
+        thread_pool& pool;
+        bool active;
+    };
+
+    template <typename T>
+    constexpr fft_precision precision_of()
+    {
+        return is_same_v<T, float> ? fft_precision::float32
+             : is_same_v<T, double> ? fft_precision::float64 : fft_precision::extended;
+    }
+
+    // Per-phase counter columns appended to the single and multi CSV rows
+    const fft_phase PROFILED_PHASES[] = {fft_phase::permute, fft_phase::butterfly, fft_phase::barrier};
+
+    void write_phase_header(ostream& out)
+    {
+        for (fft_phase phase : PROFILED_PHASES)
+        {
+            string prefix = phase_profiler::phase_name(phase);
+            prefix[0] = char(toupper(prefix[0]));
+            for (size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+            {
+                out << "," << prefix << "_" << perf_counters::event_name(perf_event(e));
+            }
+        }
+    }
+
+    // Counts that could not be measured are left empty
+    void write_counts(ostream& out, const perf_counters& perf, const perf_values& values)
+    {
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+        {
+            out << ",";
+            if (perf.has_event(perf_event(e))) out << uint64_t(values.counts[e]);
+        }
+    }
+
+    void write_phase_columns(ostream& out, const perf_counters& perf, const phase_profiler& profiler)
+    {
+        for (fft_phase phase : PROFILED_PHASES)
+        {
+            write_counts(out, perf, profiler.total(phase));
+        }
+    }
+
+    // One row per recorded phase, for the per-stage breakdown the summary columns sum over
+    void write_phase_records(ostream& out, size_t size, const perf_counters& perf, const phase_profiler& profiler)
+    {
+        for (const phase_profiler::phase_record& record : profiler.records())
+        {
+            out << size << "," << phase_profiler::phase_name(record.phase) << "," << record.stage << ","
+                << record.time_ms;
+            write_counts(out, perf, record.counters);
+            out << endl;
+        }
+    }
+
+    ofstream open_phase_file(const string& output_file_path, const perf_counters& perf)
+    {
+        ofstream out;
+        if (!perf.available()) return out;
+        out.open(output_file_path + ".phases.csv");
+        out << "Input_Size,Phase,Stage,Time_ms";
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+        {
+            out << "," << perf_counters::event_name(perf_event(e));
+        }
+        out << endl;
+        return out;
+    }
+
+    void print_counter_status(const perf_counters& perf)
+    {
+        if (perf.available())
+        {
+            cout << "  Hardware counters: " << perf.status() << endl;
+        }
+        else
+        {
+            cout << "  Hardware counters unavailable (" << perf.status() << "); counter columns are left empty"
+                << endl;
+        }
+    }
+
+    template <typename T>
+    vector<complex<T>> convert_data(const vector<complex<double>>& data)
+    {
+        vector<complex<T>> converted(data.size());
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            converted[i] = complex<T>(T(data[i].real()), T(data[i].imag()));
+        }
+        return converted;
+    }
+
+    // A float or long double result widened (or narrowed) for the double validation checks
+    template <typename T>
+    vector<complex<double>> to_double(span<const complex<T>> data)
+    {
+        vector<complex<double>> converted(data.size());
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            converted[i] = complex<double>(double(data[i].real()), double(data[i].imag()));
+        }
+        return converted;
+    }
+
+    // Acceptable error of a kernel computing in T
+    template <typename T>
+    double error_bound_for(size_t n)
+    {
+        return fft_validation::error_bound(n, double(numeric_limits<T>::epsilon()));
+    }
+}
+
+// Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults with Time_ms the
+// median and Page_Faults per run; the caller appends its own columns and the line end
+void benchmark::write_timing_row(ostream& out, size_t size, const timing_stats& stats)
+{
+    out << size << "," << stats.median_ms << "," << stats.min_ms << "," << stats.p99_ms << "," << stats.stddev_ms
+        << "," << stats.repetitions << "," << timing_harness::gflops(size, stats.median_ms) << "," << stats.page_faults;
+}
+
 benchmark::benchmark() = default;
 
-benchmark::~benchmark() = default;
+benchmark::~benchmark() = default;
+
+thread_pool& benchmark::get_pool(unsigned int num_threads)
+{
+    unique_ptr<thread_pool>& pool = pools[num_threads];
+    if (!pool)
+    {
+        pool = make_unique<thread_pool>(num_threads, cpu_topology().placement(affinity, num_threads));
+    }
+    return *pool;
+}
+
+const char* benchmark::precision_name(fft_precision precision)
+{
+    switch (precision)
+    {
+    case fft_precision::float32: return "float";
+    case fft_precision::extended: return "long-double";
+    default: return "double";
+    }
+}
+
+bool benchmark::parse_precision(const string& name, fft_precision& precision)
+{
+    for (fft_precision candidate : {fft_precision::float32, fft_precision::float64, fft_precision::extended})
+    {
+        if (name == precision_name(candidate))
+        {
+            precision = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* benchmark::radix_name(fft_radix radix)
+{
+    switch (radix)
+    {
+    case fft_radix::radix4: return "radix-4";
+    case fft_radix::split: return "split-radix";
+    default: return "radix-2";
+    }
+}
+
+vector<complex<double>> benchmark::generate_random_data(int size)
+{
+    vector<complex<double>> data;
+    data.reserve(size);
+    std::mt19937 gen(1234); // Fixed seed for reproducibility
+    std::uniform_real_distribution<> dis(-1000.0, 1000.0);
+    for (int i = 0; i < size; ++i)
+    {
+        data.emplace_back(dis(gen), 0.0);
+    }
+    return data;
+}
+
+void benchmark::set_input_file(const string& path)
+{
+    // Validates the header now so a bad file fails before any benchmark starts
+    mapped_signal signal(path, 0);
+    const signal_file_header& header = signal.header();
+    cout << "Input file " << path << ": " << header.sample_count << " "
+        << (header.layout == signal_layout::complex ? "complex" : "real") << " "
+        << (header.element_type == signal_element_type::float32 ? "float" : "double") << " samples" << endl;
+    input_file = path;
+}
+
+void benchmark::set_arena_options(const arena_options& arena_settings)
+{
+    if (arena->buffers_in_use() != 0)
+    {
+        throw logic_error("benchmark::set_arena_options: transform buffers are still in use");
+    }
+    arena = make_unique<buffer_arena>(arena_settings);
+}
+
+benchmark::input_frame benchmark::make_input_frame(int size) const
+{
+    input_frame frame;
+    if (input_file.empty())
+    {
+        frame.storage = generate_random_data(size);
+        frame.samples = frame.storage;
+        return frame;
+    }
+
+    frame.mapping = make_unique<mapped_signal>(input_file, size);
+    if (frame.mapping->size() < size_t(size))
+    {
+        return {};
+    }
+    frame.samples = frame.mapping->complex_samples<double>();
+    if (frame.samples.empty())
+    {
+        frame.storage.resize(size);
+        frame.mapping->copy_to(frame.storage);
+        frame.mapping.reset();
+        frame.samples = frame.storage;
+    }
+    return frame;
+}
+
+void benchmark::run_single_threaded_benchmark(const string& output_file_path, fft_radix radix,
+                                              fft_precision precision)
+{
+    switch (precision)
+    {
+    case fft_precision::float32: run_precision_benchmark<float>(output_file_path, nullptr); return;
+    case fft_precision::extended: run_precision_benchmark<long double>(output_file_path, nullptr); return;
+    default: break;
+    }
+
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create single results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Time_ms is the median over the harness repetitions; Permute_ms is the median of the
+    // bit-reversal pass alone, which is part of Time_ms (split-radix has none). Valid is 1 when
+    // Max_Error is within fft_validation::error_bound. The counter columns come from one extra
+    // profiled transform per size; split-radix has no stages, so its recursion is one
+    // butterfly phase. Per-stage counts go to <output>.phases.csv.
+    const timing_harness harness(options);
+    const perf_counters perf;
+    phase_profiler profiler(perf);
+    ofstream phases_stream = open_phase_file(output_file_path, perf);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Permute_ms,Max_Error,"
+        "Valid";
+    write_phase_header(results_file_stream);
+    results_file_stream << endl;
+    cout << "Running single-threaded benchmark (" << radix_name(radix) << ")..." << endl;
+    print_counter_status(perf);
+
+    for (int size : INPUT_SIZES)
+    {
+        // Random data, or the input file's samples
+        input_frame frame = make_input_frame(size);
+        if (frame.samples.empty())
+        {
+            cout << "  Input size " << size << ": skipped (input file is shorter)" << endl;
+            continue;
+        }
+        const span<const complex<double>> input = frame.samples;
+
+        // The transform buffer comes from the arena, aligned and already faulted in
+        buffer_arena::buffer buffer = arena->acquire(input.size() * sizeof(complex<double>));
+        span<complex<double>> data = buffer.view<complex<double>>();
+
+        // Plan setup is cached and kept out of the timed region
+        shared_ptr<const fft_plan> plan = fft_plan::get(size);
+
+        // Run and measure; the input is restored untimed before every run
+        const timing_stats stats = harness.measure(
+            [&] { std::copy(input.begin(), input.end(), data.begin()); },
+            [&]
+            {
+                switch (radix)
+                {
+                case fft_radix::radix2: fft_iterative(data, *plan); break;
+                case fft_radix::radix4: fft_radix4(data, *plan); break;
+                case fft_radix::split: fft_split_radix(data, *plan); break;
+                }
+            });
+        const double max_error = fft_validation::check_forward(input, data);
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        profiler.clear();
+        if (perf.available())
+        {
+            std::copy(input.begin(), input.end(), data.begin());
+            switch (radix)
+            {
+            case fft_radix::radix2: fft_iterative(data, *plan, &profiler); break;
+            case fft_radix::radix4: fft_radix4(data, *plan, &profiler); break;
+            case fft_radix::split:
+                profiler.begin_phase(fft_phase::butterfly, 0);
+                fft_split_radix(data, *plan);
+                profiler.end_phase();
+                break;
+            }
+            write_phase_records(phases_stream, size, perf, profiler);
+        }
+
+        timing_stats permute_stats;
+        if (radix != fft_radix::split)
+        {
+            permute_stats = harness.measure([] {}, [&] { bit_reversal_permutation::permute(data.data(), data.size()); });
+        }
+
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << permute_stats.median_ms << "," << max_error << "," << valid;
+        write_phase_columns(results_file_stream, perf, profiler);
+        results_file_stream << endl;
+        cout << "  Input size " << size << ": " << stats.median_ms << " ms median (min " << stats.min_ms << ", p99 "
+            << stats.p99_ms << ", " << stats.repetitions << " runs, " << timing_harness::gflops(size, stats.median_ms)
+            << " GFLOP/s, " << stats.page_faults << " faults/run, permutation " << permute_stats.median_ms
+            << " ms), max error " << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Single-threaded benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_multithreaded_benchmark(const string& output_file_path, unsigned int num_threads,
+                                            fft_radix radix, fft_precision precision)
+{
+    switch (precision)
+    {
+    case fft_precision::float32: run_precision_benchmark<float>(output_file_path, &get_pool(num_threads)); return;
+    case fft_precision::extended:
+        run_precision_benchmark<long double>(output_file_path, &get_pool(num_threads));
+        return;
+    default: break;
+    }
+
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create multi results file: " << output_file_path << endl;
+        return;
+    }
+
+    thread_pool& pool = get_pool(num_threads);
+    const double dispatch_us = pool.measure_dispatch_overhead_us();
+
+    // Counter groups are attached to the pool's threads, so they are opened after it exists.
+    // Butterfly counts cover every thread; Barrier counts are the calling thread's waits.
+    const timing_harness harness(options);
+    const perf_counters perf;
+    phase_profiler profiler(perf);
+    ofstream phases_stream = open_phase_file(output_file_path, perf);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Dispatches,"
+        "Dispatch_us,"
+        "Permute_ms,Max_Error,Valid";
+    write_phase_header(results_file_stream);
+    results_file_stream << endl;
+    cout << "Running multi-threaded benchmark (" << radix_name(radix) << ") with " << num_threads
+        << " threads..." << endl;
+    cout << "  Pool dispatch overhead: " << dispatch_us << " us per parallel step" << endl;
+    if (!pool.cpus().empty())
+    {
+        const cpu_topology topology;
+        cout << "  Placement (" << cpu_topology::policy_name(affinity) << ", " << topology.node_count() << " nodes, "
+            << topology.core_count() << " cores, " << topology.cpus().size() << " CPUs):";
+        for (int cpu : pool.cpus())
+        {
+            cout << " " << cpu << "@node" << topology.node_of(cpu);
+        }
+        cout << endl;
+    }
+    print_counter_status(perf);
+
+    for (int size : INPUT_SIZES)
+    {
+        // Random data, or the input file's samples
+        input_frame frame = make_input_frame(size);
+        if (frame.samples.empty())
+        {
+            cout << "  Input size " << size << ": skipped (input file is shorter)" << endl;
+            continue;
+        }
+        const span<const complex<double>> input = frame.samples;
+
+        // A new arena block is faulted in share by share by the participants that work on it
+        // first, so on a NUMA machine each share is local to its thread
+        buffer_arena::buffer buffer = arena->acquire(input.size() * sizeof(complex<double>), &pool);
+        span<complex<double>> data = buffer.view<complex<double>>();
+
+        // Plan setup is cached and kept out of the timed region
+        shared_ptr<const fft_plan> plan = fft_plan::get(size);
+
+        // Run and measure; the input is restored untimed before every run
+        uint64_t dispatches = 0;
+        const timing_stats stats = harness.measure(
+            [&] { std::copy(input.begin(), input.end(), data.begin()); },
+            [&]
+            {
+                const uint64_t dispatches_before = pool.dispatch_count();
+                if (radix == fft_radix::radix4)
+                {
+                    fft_radix4_multithreaded(data, *plan, pool);
+                }
+                else
+                {
+                    fft_iterative_multithreaded(data, *plan, pool);
+                }
+                dispatches = pool.dispatch_count() - dispatches_before;
+            });
+        const double max_error = fft_validation::check_forward(input, data);
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        profiler.clear();
+        if (perf.available())
+        {
+            std::copy(input.begin(), input.end(), data.begin());
+            if (radix == fft_radix::radix4)
+            {
+                fft_radix4_multithreaded(data, *plan, pool, &profiler);
+            }
+            else
+            {
+                fft_iterative_multithreaded(data, *plan, pool, &profiler);
+            }
+            write_phase_records(phases_stream, size, perf, profiler);
+        }
+
+        // The parallel bit-reversal pass alone
+        const timing_stats permute_stats =
+            harness.measure([] {}, [&] { bit_reversal_permutation::permute(data.data(), data.size(), pool); });
+
+        // Dispatches are per transform; Dispatch_us is the pool's cost for one woken step, so
+        // Dispatches * Dispatch_us is the part of Time_ms that is pure synchronization
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << dispatches << "," << dispatch_us << "," << permute_stats.median_ms << ","
+            << max_error << "," << valid;
+        write_phase_columns(results_file_stream, perf, profiler);
+        results_file_stream << endl;
+        cout << "  Input size " << size << ": " << stats.median_ms << " ms median (min " << stats.min_ms << ", p99 "
+            << stats.p99_ms << ", " << stats.repetitions << " runs, " << timing_harness::gflops(size, stats.median_ms)
+            << " GFLOP/s, " << stats.page_faults << " faults/run, " << dispatches << " dispatches, ~"
+            << dispatches * dispatch_us / 1000.0 << " ms overhead, permutation " << permute_stats.median_ms << " ms), max error " << max_error
+            << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Multi-threaded benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+
+
+void benchmark::run_four_step_benchmark(const string& output_file_path)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create four-step results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Same timing and validation columns as the single-threaded runs; Rows x Cols is the split
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Rows,Cols,"
+        "Max_Error,Valid" << endl;
+    cout << "Running four-step benchmark..." << endl;
+
+    for (int size : INPUT_SIZES)
+    {
+        const vector<complex<double>> input = generate_random_data(size);
+        buffer_arena::buffer buffer = arena->acquire(input.size() * sizeof(complex<double>));
+        span<complex<double>> data = buffer.view<complex<double>>();
+
+        // Sub-plans, twiddle tables and the transpose buffer are set up outside the timed region
+        four_step_fft engine(size);
+
+        // Run and measure; the input is restored untimed before every run
+        const timing_stats stats = harness.measure([&] { std::copy(input.begin(), input.end(), data.begin()); },
+                                                   [&] { engine.execute(data); });
+        const double max_error = fft_validation::check_forward(input, data);
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << engine.rows() << "," << engine.cols() << "," << max_error << "," << valid
+            << endl;
+        cout << "  Input size " << size << " (" << engine.rows() << " x " << engine.cols() << "): "
+            << stats.median_ms << " ms median (min " << stats.min_ms << ", " << stats.repetitions
+            << " runs), max error " << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Four-step benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_simd_benchmark(const string& output_file_path, simd_isa isa, fft_precision precision)
+{
+    if (precision == fft_precision::float32)
+    {
+        run_simd_precision_benchmark<float>(output_file_path, isa);
+        return;
+    }
+
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create SIMD results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Permute_ms is the median of the bit reversal of both split halves alone, part of Time_ms
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Permute_ms,"
+        "Max_Error,Valid" << endl;
+    cout << "Running SIMD benchmark (" << simd_fft::isa_name(isa) << ")..." << endl;
+
+    vector<complex<double>> result;
+    for (int size : INPUT_SIZES)
+    {
+        // Random data in the split layout the vector kernels work on
+        const vector<complex<double>> input = generate_random_data(size);
+        const split_complex_buffer source = split_complex_buffer::from_interleaved(input);
+        split_complex_buffer data(size);
+        shared_ptr<const fft_plan> plan = fft_plan::get(size);
+
+        // Run and measure; the input is restored untimed before every run
+        const timing_stats stats = harness.measure(
+            [&]
+            {
+                std::copy(source.re.begin(), source.re.end(), data.re.begin());
+                std::copy(source.im.begin(), source.im.end(), data.im.begin());
+            },
+            [&] { simd_fft::execute(data, *plan, isa); });
+        result.resize(size);
+        data.to_interleaved(result);
+        const double max_error = fft_validation::check_forward(input, result);
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        // Both split halves are permuted, as inside execute
+        const timing_stats permute_stats = harness.measure([] {}, [&]
+        {
+            bit_reversal_permutation::permute(data.re.data(), data.size());
+            bit_reversal_permutation::permute(data.im.data(), data.size());
+        });
+
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << permute_stats.median_ms << "," << max_error << "," << valid << endl;
+        cout << "  Input size " << size << ": " << stats.median_ms << " ms median (min " << stats.min_ms << ", "
+            << stats.repetitions << " runs, permutation " << permute_stats.median_ms << " ms), max error "
+            << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "SIMD benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+template <typename T>
+void benchmark::run_precision_benchmark(const string& output_file_path, thread_pool* pool)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create precision results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Same timing columns as the double runs; Max_Error is fft_validation::check_forward of
+    // the result widened to double, Valid compares it with the bound for T's epsilon
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Max_Error,Valid"
+        << endl;
+    cout << "Running " << (pool ? "multi" : "single") << "-threaded benchmark (radix-2, "
+        << precision_name(precision_of<T>()) << ")";
+    if (pool) cout << " with " << pool->size() << " threads";
+    cout << "..." << endl;
+
+    for (int size : INPUT_SIZES)
+    {
+        // Random data, converted to T once outside the timed region
+        const vector<complex<double>> input = generate_random_data(size);
+        const vector<complex<T>> converted = convert_data<T>(input);
+        buffer_arena::buffer buffer = arena->acquire(converted.size() * sizeof(complex<T>));
+        span<complex<T>> data = buffer.view<complex<T>>();
+
+        // Plan setup is cached and kept out of the timed region
+        shared_ptr<const basic_fft_plan<T>> plan = basic_fft_plan<T>::get(size);
+
+        // Run and measure; the input is restored untimed before every run
+        const timing_stats stats = harness.measure(
+            [&] { std::copy(converted.begin(), converted.end(), data.begin()); },
+            [&]
+            {
+                if (pool)
+                {
+                    fft_iterative_multithreaded(data, *plan, *pool);
+                }
+                else
+                {
+                    fft_iterative(data, *plan);
+                }
+            });
+        const double max_error = fft_validation::check_forward(input, to_double<T>(data));
+        const bool valid = max_error <= error_bound_for<T>(size);
+
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << max_error << "," << valid << endl;
+        cout << "  Input size " << size << ": " << stats.median_ms << " ms median (min " << stats.min_ms << ", "
+            << stats.repetitions << " runs), max error " << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Precision benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+template <typename T>
+void benchmark::run_simd_precision_benchmark(const string& output_file_path, simd_isa isa)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create SIMD results file: " << output_file_path << endl;
+        return;
+    }
+
+    // As the double SIMD run without Permute_ms; Valid compares Max_Error with the bound for T
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Max_Error,Valid"
+        << endl;
+    cout << "Running SIMD benchmark (" << simd_fft::isa_name(isa) << ", " << simd_fft::lanes<T>(isa)
+        << " lanes of " << sizeof(T) * 8 << "-bit)..." << endl;
+
+    vector<complex<T>> result;
+    for (int size : INPUT_SIZES)
+    {
+        // Random data in the split layout the vector kernels work on, converted to T once
+        const vector<complex<double>> input = generate_random_data(size);
+        const basic_split_complex_buffer<T> source =
+            basic_split_complex_buffer<T>::from_interleaved(convert_data<T>(input));
+        basic_split_complex_buffer<T> data(size);
+        shared_ptr<const basic_fft_plan<T>> plan = basic_fft_plan<T>::get(size);
+
+        // Run and measure; the input is restored untimed before every run
+        const timing_stats stats = harness.measure(
+            [&]
+            {
+                std::copy(source.re.begin(), source.re.end(), data.re.begin());
+                std::copy(source.im.begin(), source.im.end(), data.im.begin());
+            },
+            [&] { simd_fft::execute(data, *plan, isa); });
+        result.resize(size);
+        data.to_interleaved(result);
+        const double max_error = fft_validation::check_forward(input, to_double<T>(result));
+        const bool valid = max_error <= error_bound_for<T>(size);
+
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << max_error << "," << valid << endl;
+        cout << "  Input size " << size << ": " << stats.median_ms << " ms median (min " << stats.min_ms << ", "
+            << stats.repetitions << " runs), max error " << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "SIMD benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_mixed_radix_benchmark(const string& output_file_path)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create mixed-radix results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Padded_Time_ms is the median of the radix-4 transform of the same frame zero-padded to
+    // Padded_Size, i.e. what these sizes cost before. Above fft_validation::DFT_MAX_SIZE the
+    // result is checked by a round trip through the inverse plan of the same algorithm.
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Algorithm,"
+        "Padded_Size,Padded_Time_ms,Max_Error,Valid" << endl;
+    cout << "Running mixed-radix / Bluestein benchmark..." << endl;
+
+    for (int size : NON_POW2_SIZES)
+    {
+        const vector<complex<double>> input = generate_random_data(size);
+        vector<complex<double>> data(size);
+
+        size_t padded_size = 1;
+        while (padded_size < size_t(size)) padded_size <<= 1;
+        vector<complex<double>> padded(padded_size);
+
+        // Plans are built and cached outside the timed region
+        const bool smooth = mixed_radix_fft::is_smooth(size);
+        shared_ptr<const mixed_radix_fft> mixed_plan = smooth ? mixed_radix_fft::get(size) : nullptr;
+        shared_ptr<const bluestein_fft> bluestein_plan = smooth ? nullptr : bluestein_fft::get(size);
+        shared_ptr<const fft_plan> padded_plan = fft_plan::get(padded_size);
+
+        // Run and measure; the input is restored untimed before every run
+        const timing_stats stats = harness.measure(
+            [&] { std::copy(input.begin(), input.end(), data.begin()); },
+            [&]
+            {
+                if (smooth)
+                {
+                    mixed_plan->execute(data);
+                }
+                else
+                {
+                    bluestein_plan->execute(data);
+                }
+            });
+        const double max_error = fft_validation::check_forward(input, data, [&](span<complex<double>> spectrum)
+        {
+            if (smooth)
+            {
+                mixed_radix_fft::get(size, fft_direction::inverse)->execute(spectrum);
+            }
+            else
+            {
+                bluestein_fft::get(size, fft_direction::inverse)->execute(spectrum);
+            }
+        });
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        const timing_stats padded_stats = harness.measure(
+            [&]
+            {
+                std::copy(input.begin(), input.end(), padded.begin());
+                std::fill(padded.begin() + size, padded.end(), complex<double>());
+            },
+            [&] { fft_radix4(padded, *padded_plan); });
+
+        const char* algorithm = smooth ? "mixed-radix" : "bluestein";
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << algorithm << "," << padded_size << "," << padded_stats.median_ms << ","
+            << max_error << "," << valid << endl;
+        cout << "  Input size " << size << " (" << algorithm << "): " << stats.median_ms << " ms median (min "
+            << stats.min_ms << ", " << stats.repetitions << " runs), padded to " << padded_size << ": "
+            << padded_stats.median_ms << " ms, max error " << max_error << (valid ? "" : " FAILED VALIDATION")
+            << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Mixed-radix benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_real_benchmark(const string& output_file_path)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create real results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Time_ms is the r2c transform, Inverse_Time_ms the c2r transform of its output, and
+    // Complex_Time_ms the full complex transform of the same signal with the same kernel, all
+    // harness medians. The complex result is checked with fft_validation::check_forward, the
+    // r2c bins against its first N / 2 + 1 and the c2r output against N times the signal.
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,"
+        "Inverse_Time_ms,Complex_Time_ms,Max_Error,Valid" << endl;
+    cout << "Running real-input (r2c/c2r) benchmark..." << endl;
+
+    for (int size : INPUT_SIZES)
+    {
+        // The same real signal as the complex benchmarks
+        const vector<complex<double>> input = generate_random_data(size);
+        vector<double> signal(size);
+        for (int i = 0; i < size; ++i)
+        {
+            signal[i] = input[i].real();
+        }
+        vector<complex<double>> complex_data(size);
+        vector<complex<double>> spectrum(size / 2 + 1);
+        vector<double> restored(size);
+
+        shared_ptr<const real_fft> plan = real_fft::get(size);
+        shared_ptr<const fft_plan> complex_plan = fft_plan::get(size);
+
+        // Run and measure; r2c and c2r write their own outputs, the complex run is restored
+        const timing_stats stats = harness.measure([] {}, [&] { plan->forward(signal, spectrum); });
+        const timing_stats inverse_stats = harness.measure([] {}, [&] { plan->inverse(spectrum, restored); });
+        const timing_stats complex_stats = harness.measure(
+            [&] { std::copy(input.begin(), input.end(), complex_data.begin()); },
+            [&] { fft_radix4(complex_data, *complex_plan); });
+
+        double max_error = fft_validation::check_forward(input, complex_data);
+        max_error = std::max(max_error, fft_validation::relative_error<double>(
+            spectrum, span<const complex<double>>(complex_data.data(), spectrum.size())));
+        double max_diff = 0.0;
+        double max_ref = 0.0;
+        for (int i = 0; i < size; ++i)
+        {
+            max_diff = std::max(max_diff, std::abs(restored[i] / size - signal[i]));
+            max_ref = std::max(max_ref, std::abs(signal[i]));
+        }
+        max_error = std::max(max_error, max_ref > 0.0 ? max_diff / max_ref : max_diff);
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << inverse_stats.median_ms << "," << complex_stats.median_ms << "," << max_error
+            << "," << valid << endl;
+        cout << "  Input size " << size << ": r2c " << stats.median_ms << " ms, c2r " << inverse_stats.median_ms
+            << " ms, complex " << complex_stats.median_ms << " ms (medians), max error " << max_error
+            << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Real-input benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_convolution_benchmark(const string& output_file_path)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create convolution results file: " << output_file_path << endl;
+        return;
+    }
+
+    // Times are medians for the whole stream; the FFT methods take it in chunks as a live
+    // stream would. Speedup is Direct_ms over the faster FFT method, Max_Error the larger
+    // deviation of the two from the direct result. Each block goes through a forward and an
+    // inverse transform of FFT_Size, so Valid is 1 within the round-trip bound for that size.
+    const timing_harness harness(options);
+    results_file_stream << "Filter_Length,FFT_Size,Direct_ms,Overlap_Add_ms,Overlap_Save_ms,Speedup,Max_Error,"
+        "Valid" << endl;
+    cout << "Running convolution benchmark (" << CONVOLUTION_STREAM_LENGTH << " samples in chunks of "
+        << CONVOLUTION_CHUNK << ")..." << endl;
+
+    // Generate random data: the real part of the usual signal, and an unrelated filter
+    vector<double> input(CONVOLUTION_STREAM_LENGTH);
+    const vector<complex<double>> signal = generate_random_data(int(CONVOLUTION_STREAM_LENGTH));
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = signal[i].real();
+    }
+    std::mt19937 gen(4321);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+
+    int crossover = 0;
+    for (int length : FILTER_LENGTHS)
+    {
+        vector<double> filter(length);
+        for (double& tap : filter)
+        {
+            tap = dis(gen);
+        }
+
+        // Direct reference
+        vector<double> reference;
+        const timing_stats direct_stats = harness.measure([] {}, [&]
+        {
+            fast_convolver::direct(input, filter, convolution_kind::convolution, reference);
+        });
+
+        // Both block methods; the filter spectrum is computed once, outside the timed region
+        double fft_ms[2];
+        double max_error = 0.0;
+        size_t fft_size = 0;
+        const convolution_method methods[2] = {convolution_method::overlap_add, convolution_method::overlap_save};
+        for (int i = 0; i < 2; ++i)
+        {
+            fast_convolver convolver(filter, methods[i]);
+            fft_size = convolver.fft_size();
+            vector<double> output;
+            output.reserve(input.size() + length - 1);
+            const timing_stats stats = harness.measure([&] { output.clear(); }, [&]
+            {
+                for (size_t offset = 0; offset < input.size(); offset += CONVOLUTION_CHUNK)
+                {
+                    convolver.process(span<const double>(input).subspan(
+                                          offset, std::min(CONVOLUTION_CHUNK, input.size() - offset)), output);
+                }
+                convolver.flush(output);
+            });
+            fft_ms[i] = stats.median_ms;
+
+            // Relative to the largest reference output, as for the transforms
+            double max_diff = 0.0;
+            double max_ref = 0.0;
+            for (size_t k = 0; k < reference.size(); ++k)
+            {
+                max_diff = std::max(max_diff, abs(output[k] - reference[k]));
+                max_ref = std::max(max_ref, abs(reference[k]));
+            }
+            max_error = std::max(max_error, max_ref > 0.0 ? max_diff / max_ref : max_diff);
+        }
+
+        const double speedup = direct_stats.median_ms / std::min(fft_ms[0], fft_ms[1]);
+        const bool valid = max_error <= fft_validation::error_bound(fft_size);
+        if (speedup > 1.0 && crossover == 0)
+        {
+            crossover = length;
+        }
+        results_file_stream << length << "," << fft_size << "," << direct_stats.median_ms << "," << fft_ms[0] << ","
+            << fft_ms[1] << "," << speedup << "," << max_error << "," << valid << endl;
+        cout << "  Filter length " << length << " (FFT size " << fft_size << "): direct " << direct_stats.median_ms
+            << " ms, overlap-add " << fft_ms[0] << " ms, overlap-save " << fft_ms[1] << " ms, speedup " << speedup
+            << ", max error " << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    if (crossover != 0)
+    {
+        cout << "  FFT convolution is faster from filter length " << crossover << endl;
+    }
+    else
+    {
+        cout << "  Direct convolution was faster at every filter length" << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Convolution benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_batch_benchmark(const string& output_file_path, unsigned int num_threads, simd_isa isa)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create batch results file: " << output_file_path << endl;
+        return;
+    }
+
+    thread_pool& pool = get_pool(num_threads);
+
+    // The timing columns are for the whole batch (GFLOPS counts one transform); Looped_Time_ms
+    // is the median of the same batch done as one fft_iterative call per frame on one thread.
+    // Max_Error is the worst frame of either run against a naive DFT of the signal.
+    const timing_harness harness(options);
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Batch_Size,"
+        "Transforms_per_s,Looped_Time_ms,Max_Error,Valid" << endl;
+    cout << "Running batched benchmark (" << simd_fft::isa_name(isa) << ", " << num_threads << " threads)..." << endl;
+
+    for (int size : BATCH_FFT_SIZES)
+    {
+        batched_fft engine(size, fft_direction::forward, isa);
+        shared_ptr<const fft_plan> plan = fft_plan::get(size);
+        const vector<complex<double>> frame = generate_random_data(size);
+        const vector<complex<double>> reference = fft_validation::naive_dft(frame);
+
+        for (int batch : BATCH_SIZES)
+        {
+            // Contiguous [batch][N] buffers, every frame holding the same random signal
+            vector<complex<double>> data(size_t(size) * batch);
+            vector<complex<double>> looped(data.size());
+            auto restore = [&](vector<complex<double>>& buffer)
+            {
+                for (int b = 0; b < batch; ++b)
+                {
+                    std::copy(frame.begin(), frame.end(), buffer.begin() + size_t(b) * size);
+                }
+            };
+
+            // Run and measure; the frames are restored untimed before every run
+            const timing_stats stats = harness.measure([&] { restore(data); },
+                                                       [&] { engine.execute(data.data(), batch, &pool); });
+            const timing_stats looped_stats = harness.measure([&] { restore(looped); }, [&]
+            {
+                for (int b = 0; b < batch; ++b)
+                {
+                    fft_iterative(span<complex<double>>(looped.data() + size_t(b) * size, size), *plan);
+                }
+            });
+
+            double max_error = 0.0;
+            for (int b = 0; b < batch; ++b)
+            {
+                for (const vector<complex<double>>* result : {&data, &looped})
+                {
+                    const span<const complex<double>> transformed(result->data() + size_t(b) * size, size);
+                    max_error = std::max(max_error, fft_validation::relative_error<double>(transformed, reference));
+                }
+            }
+            const bool valid = max_error <= fft_validation::error_bound(size);
+
+            const double transforms_per_s = batch / (stats.median_ms / 1000.0);
+            write_timing_row(results_file_stream, size, stats);
+            results_file_stream << "," << batch << "," << transforms_per_s << "," << looped_stats.median_ms << ","
+                << max_error << "," << valid << endl;
+            cout << "  N " << size << " x " << batch << ": " << stats.median_ms << " ms median (" << transforms_per_s
+                << " transforms/s), looped " << looped_stats.median_ms << " ms, max error " << max_error
+                << (valid ? "" : " FAILED VALIDATION") << endl;
+        }
+    }
+
+    results_file_stream.close();
+    cout << "Batched benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_stft_benchmark(const string& output_file_path, unsigned int num_threads, simd_isa isa,
+                                   window_kind window)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create STFT results file: " << output_file_path << endl;
+        return;
+    }
+
+    thread_pool& pool = get_pool(num_threads);
+    const timing_harness harness(options);
+
+    // Time_ms is the median for the whole stream, magnitudes copied out to a spectrogram as a
+    // consumer would. The latencies are over every frame of the last run; samples are pushed
+    // as fast as they are processed, so they hold the processing delay and the wait for a
+    // batch to fill in processing time, not the (batch - 1) hops a live stream would add.
+    // Naive_Frames_per_s copies, windows and runs fft_iterative once per frame on one thread;
+    // Valid is 1 when the magnitudes are within fft_validation::error_bound of the window size.
+    results_file_stream << "Window_Size,Hop,Batch_Frames,Frames,Time_ms,Frames_per_s,Latency_Median_ms,"
+        "Latency_P99_ms,Naive_Frames_per_s,Max_Error,Valid" << endl;
+    cout << "Running STFT benchmark (" << streaming_stft::window_name(window) << " window, "
+        << simd_fft::isa_name(isa) << ", " << num_threads << " threads, " << STFT_STREAM_LENGTH
+        << " samples in chunks of " << STFT_CHUNK << ")..." << endl;
+
+    // Generate random data: the real part of the usual signal
+    vector<double> input(STFT_STREAM_LENGTH);
+    const vector<complex<double>> signal = generate_random_data(int(STFT_STREAM_LENGTH));
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = signal[i].real();
+    }
+
+    for (int size : STFT_WINDOW_SIZES)
+    {
+        const size_t n = size;
+        const size_t bins = n / 2 + 1;
+        shared_ptr<const fft_plan> plan = fft_plan::get(n);
+        const vector<double> coefficients = streaming_stft::make_window(window, n);
+
+        for (int overlap : STFT_OVERLAPS)
+        {
+            const size_t hop = n / overlap;
+            const size_t frames = (input.size() - n) / hop + 1;
+
+            // Baseline: a fresh copy of every frame through the scalar radix-2 kernel
+            vector<double> reference(frames * bins);
+            const timing_stats naive_stats = harness.measure([] {}, [&]
+            {
+                for (size_t frame = 0; frame < frames; ++frame)
+                {
+                    vector<complex<double>> buffer(n);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        buffer[i] = input[frame * hop + i] * coefficients[i];
+                    }
+                    fft_iterative(span<complex<double>>(buffer), *plan);
+                    for (size_t k = 0; k < bins; ++k)
+                    {
+                        reference[frame * bins + k] = abs(buffer[k]);
+                    }
+                }
+            });
+            const double naive_frames_per_s = frames / (naive_stats.median_ms / 1000.0);
+
+            for (int batch : STFT_BATCH_FRAMES)
+            {
+                stft_options settings;
+                settings.window_size = n;
+                settings.hop = hop;
+                settings.window = window;
+                settings.batch_frames = batch;
+                settings.ring_frames = std::max<size_t>(256, batch);
+                streaming_stft stft(settings, isa, &pool);
+
+                vector<double> spectrogram(frames * bins);
+                vector<double> latencies;
+                latencies.reserve(frames);
+                auto consume = [&]
+                {
+                    stft_frame frame;
+                    while (stft.pop(frame))
+                    {
+                        std::copy(frame.values.begin(), frame.values.end(), spectrogram.begin() + frame.index * bins);
+                        latencies.push_back(frame.latency_ms);
+                    }
+                };
+                const timing_stats stats = harness.measure([&] { stft.reset(); latencies.clear(); }, [&]
+                {
+                    for (size_t offset = 0; offset < input.size(); offset += STFT_CHUNK)
+                    {
+                        stft.push(span<const double>(input).subspan(
+                                      offset, std::min(STFT_CHUNK, input.size() - offset)));
+                        consume();
+                    }
+                    stft.flush();
+                    consume();
+                });
+
+                std::sort(latencies.begin(), latencies.end());
+                const double latency_median = latencies.empty() ? 0.0 : latencies[latencies.size() / 2];
+                const double latency_p99 = latencies.empty() ? 0.0 :
+                    latencies[std::min(latencies.size() - 1, size_t(0.99 * double(latencies.size())))];
+                const double frames_per_s = frames / (stats.median_ms / 1000.0);
+
+                // Relative to the largest reference magnitude, as for the transforms
+                double max_diff = 0.0;
+                double max_ref = 0.0;
+                for (size_t k = 0; k < reference.size(); ++k)
+                {
+                    max_diff = std::max(max_diff, abs(spectrogram[k] - reference[k]));
+                    max_ref = std::max(max_ref, reference[k]);
+                }
+                const double max_error = max_ref > 0.0 ? max_diff / max_ref : max_diff;
+                const bool valid = max_error <= fft_validation::error_bound(n);
+
+                results_file_stream << n << "," << hop << "," << batch << "," << frames << "," << stats.median_ms
+                    << "," << frames_per_s << "," << latency_median << "," << latency_p99 << ","
+                    << naive_frames_per_s << "," << max_error << "," << valid << endl;
+                cout << "  N " << n << ", hop " << hop << ", batch " << batch << ": " << frames_per_s
+                    << " frames/s (naive " << naive_frames_per_s << "), latency median " << latency_median
+                    << " ms, p99 " << latency_p99 << " ms, max error " << max_error
+                    << (valid ? "" : " FAILED VALIDATION") << endl;
+            }
+        }
+    }
+
+    results_file_stream.close();
+    cout << "STFT benchmark finished. Results saved to " << output_file_path << endl;
+}
 
-void benchmark::run_single_threaded_benchmark(const string& output_file_path)
+void benchmark::run_multidim_benchmark(const string& output_file_path, unsigned int num_threads, simd_isa isa)
 {
     ofstream results_file_stream(output_file_path);
 
     if (!results_file_stream.is_open())
     {
-        cerr << "Failed to create single results file: " << output_file_path << endl;
+        cerr << "Failed to create multidimensional results file: " << output_file_path << endl;
+        return;
+    }
+
+    thread_pool& pool = get_pool(num_threads);
+    const timing_harness harness(options);
+
+    // Time_ms is the median of the transposed passes, Strided_Time_ms the same transform with
+    // the column passes gathered at a stride, and Naive_Time_ms the median of fft_iterative per
+    // row of every axis on one thread, copied out and back; its result is the reference. The
+    // axes together take log2(Input_Size) stages, so Valid uses the bound for Input_Size points.
+    results_file_stream << "Shape,Input_Size,Time_ms,GFLOPS,Strided_Time_ms,Naive_Time_ms,Max_Error,Valid" << endl;
+    cout << "Running multidimensional benchmark (" << simd_fft::isa_name(isa) << ", " << num_threads
+        << " threads)..." << endl;
+
+    for (const vector<size_t>& shape : MULTIDIM_SHAPES)
+    {
+        string name;
+        for (size_t side : shape)
+        {
+            if (!name.empty()) name += 'x';
+            name += to_string(side);
+        }
+
+        multidim_fft engine(shape, fft_direction::forward, isa);
+        const size_t total = engine.size();
+        const vector<complex<double>> input = generate_random_data(int(total));
+        vector<complex<double>> data(total);
+        auto restore = [&] { std::copy(input.begin(), input.end(), data.begin()); };
+
+        // Baseline and reference: every axis row by row through a fresh contiguous copy
+        vector<complex<double>> reference(total);
+        const timing_stats naive_stats = harness.measure(
+            [&] { std::copy(input.begin(), input.end(), reference.begin()); },
+            [&]
+            {
+                size_t inner = 1;
+                for (size_t axis = shape.size(); axis-- > 0;)
+                {
+                    const size_t length = shape[axis];
+                    shared_ptr<const fft_plan> plan = fft_plan::get(length);
+                    for (size_t outer = 0; outer < total; outer += length * inner)
+                    {
+                        for (size_t offset = outer; offset < outer + inner; ++offset)
+                        {
+                            vector<complex<double>> row(length);
+                            for (size_t i = 0; i < length; ++i)
+                            {
+                                row[i] = reference[offset + i * inner];
+                            }
+                            fft_iterative(span<complex<double>>(row), *plan);
+                            for (size_t i = 0; i < length; ++i)
+                            {
+                                reference[offset + i * inner] = row[i];
+                            }
+                        }
+                    }
+                    inner *= length;
+                }
+            });
+        const double naive_ms = naive_stats.median_ms;
+
+        const timing_stats strided_stats = harness.measure(restore, [&] { engine.execute_strided(data.data(), &pool); });
+        const double strided_error = fft_validation::relative_error<double>(data, reference);
+        const timing_stats stats = harness.measure(restore, [&] { engine.execute(data.data(), &pool); });
+        const double max_error = std::max(strided_error, fft_validation::relative_error<double>(data, reference));
+        const bool valid = max_error <= fft_validation::error_bound(total);
+
+        results_file_stream << name << "," << total << "," << stats.median_ms << ","
+            << timing_harness::gflops(total, stats.median_ms) << "," << strided_stats.median_ms << "," << naive_ms
+            << "," << max_error << "," << valid << endl;
+        cout << "  " << name << ": " << stats.median_ms << " ms (" << timing_harness::gflops(total, stats.median_ms)
+            << " GFLOPS), strided " << strided_stats.median_ms << " ms, naive " << naive_ms << " ms, max error "
+            << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+
+    results_file_stream.close();
+    cout << "Multidimensional benchmark finished. Results saved to " << output_file_path << endl;
+}
+
+void benchmark::run_tune_benchmark(const string& output_file_path, const string& wisdom_path,
+                                   unsigned int max_threads, simd_isa isa)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create tuning results file: " << output_file_path << endl;
         return;
     }
 
-    results_file_stream << "Input_Size,Time_ms" << endl;
-    cout << "Running single-threaded benchmark..." << endl;
+    // Entries for sizes this run does not cover are kept
+    fft_wisdom wisdom(cpu_topology::model_name());
+    wisdom.load(wisdom_path);
+    const timing_harness harness(options);
+
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Engine,Threads,"
+        "ISA,Block,Max_Error,Valid,Best" << endl;
+    cout << "Tuning for " << wisdom.model() << " (up to " << max_threads << " threads, "
+        << simd_fft::isa_name(isa) << ")..." << endl;
 
     for (int size : INPUT_SIZES)
     {
-        // Generate random data
-        vector<complex<double>> data;
-        data.reserve(size);
-        std::mt19937 gen(1234); // Fixed seed for reproducibility
-        std::uniform_real_distribution<> dis(-1000.0, 1000.0);
-        for (int i = 0; i < size; ++i)
+        const vector<complex<double>> input = generate_random_data(size);
+        buffer_arena::buffer buffer = arena->acquire(input.size() * sizeof(complex<double>));
+        span<complex<double>> data = buffer.view<complex<double>>();
+
+        // Every candidate on the same input, the input restored untimed before every run
+        const vector<fft_choice> candidates = tuned_fft::candidates(size, max_threads, isa);
+        vector<timing_stats> stats(candidates.size());
+        vector<double> errors(candidates.size());
+        size_t best = candidates.size();
+        for (size_t c = 0; c < candidates.size(); ++c)
         {
-            data.emplace_back(dis(gen), 0.0);
+            tuned_fft engine(size, candidates[c]);
+            thread_pool* participants = candidates[c].threads > 1 ? &get_pool(candidates[c].threads) : nullptr;
+            stats[c] = harness.measure([&] { std::copy(input.begin(), input.end(), data.begin()); },
+                                       [&] { engine.execute(data, participants); });
+            errors[c] = fft_validation::check_forward(input, data);
+            const bool valid = errors[c] <= fft_validation::error_bound(size);
+            if (valid && (best == candidates.size() || stats[c].median_ms < stats[best].median_ms))
+            {
+                best = c;
+            }
         }
 
-        // Run and measure
-        auto start = chrono::high_resolution_clock::now();
-        fft_iterative(data);
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double, milli> duration = end - start;
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            write_timing_row(results_file_stream, size, stats[c]);
+            results_file_stream << "," << tuned_fft::engine_name(candidates[c].engine) << "," << candidates[c].threads
+                << "," << simd_fft::isa_name(candidates[c].isa) << "," << candidates[c].block << "," << errors[c]
+                << ","
+                << (errors[c] <= fft_validation::error_bound(size)) << "," << (c == best) << endl;
+        }
+        if (best == candidates.size())
+        {
+            cout << "  Input size " << size << ": no candidate passed validation, nothing recorded" << endl;
+            continue;
+        }
 
-        results_file_stream << size << "," << duration.count() << endl;
-        cout << "  Input size " << size << ": " << duration.count() << " ms"
-            << endl;
+        fft_choice winner = candidates[best];
+        winner.time_ms = stats[best].median_ms;
+        wisdom.record(size, winner);
+        cout << "  Input size " << size << ": " << tuned_fft::describe(winner) << " " << winner.time_ms << " ms (of "
+            << candidates.size() << " candidates)" << endl;
     }
 
     results_file_stream.close();
-    cout << "Single-threaded benchmark finished. Results saved to " << output_file_path << endl;
+    wisdom.save(wisdom_path);
+    cout << "Tuning finished. Results saved to " << output_file_path << ", wisdom to " << wisdom_path << endl;
 }
 
-void benchmark::run_multithreaded_benchmark(const string& output_file_path, unsigned int num_threads)
+void benchmark::run_auto_benchmark(const string& output_file_path, const string& wisdom_path,
+                                   unsigned int default_threads)
 {
     ofstream results_file_stream(output_file_path);
 
     if (!results_file_stream.is_open())
     {
-        cerr << "Failed to create multi results file: " << output_file_path << endl;
+        cerr << "Failed to create auto results file: " << output_file_path << endl;
         return;
     }
 
-    results_file_stream << "Input_Size,Time_ms" << endl;
-    cout << "Running multi-threaded benchmark with " << num_threads << " threads..." << endl;
+    fft_wisdom wisdom(cpu_topology::model_name());
+    if (!wisdom.load(wisdom_path) || wisdom.size() == 0)
+    {
+        cerr << "Warning: no wisdom for " << wisdom.model() << " in " << wisdom_path
+            << "; every size falls back to radix-2 on " << default_threads << " threads (run --mode tune first)"
+            << endl;
+    }
+    const timing_harness harness(options);
+
+    // Block is the one the engine used; Tuned_ms is the median the tuning run recorded, empty
+    // for sizes without an entry
+    results_file_stream << "Input_Size,Time_ms,Min_ms,P99_ms,Stddev_ms,Repetitions,GFLOPS,Page_Faults,Engine,Threads,"
+        "ISA,Block,Tuned_ms,Max_Error,Valid" << endl;
+    cout << "Running auto benchmark from " << wisdom_path << " (" << wisdom.size() << " sizes for " << wisdom.model()
+        << ")..." << endl;
 
     for (int size : INPUT_SIZES)
     {
-        // Generate random data
-        vector<complex<double>> data;
-        data.reserve(size);
-        std::mt19937 gen(1234); // Fixed seed for reproducibility
-        std::uniform_real_distribution<> dis(-1000.0, 1000.0);
-        for (int i = 0; i < size; ++i)
+        const fft_choice* tuned = wisdom.find(size);
+        fft_choice choice;
+        if (tuned) choice = *tuned;
+        else choice.threads = default_threads;
+
+        input_frame frame = make_input_frame(size);
+        if (frame.samples.empty())
         {
-            data.emplace_back(dis(gen), 0.0);
+            cout << "  Input size " << size << ": skipped (input file is shorter)" << endl;
+            continue;
         }
+        const span<const complex<double>> input = frame.samples;
+        thread_pool* participants = choice.threads > 1 ? &get_pool(choice.threads) : nullptr;
+        buffer_arena::buffer buffer = arena->acquire(input.size() * sizeof(complex<double>), participants);
+        span<complex<double>> data = buffer.view<complex<double>>();
 
-        // Run and measure
-        auto start = chrono::high_resolution_clock::now();
-        fft_iterative_multithreaded(data, num_threads);
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double, milli> duration = end - start;
+        tuned_fft engine(size, choice);
+        const timing_stats stats = harness.measure([&] { std::copy(input.begin(), input.end(), data.begin()); },
+                                                   [&] { engine.execute(data, participants); });
+        const double max_error = fft_validation::check_forward(input, data);
+        const bool valid = max_error <= fft_validation::error_bound(size);
 
-        results_file_stream << size << "," << duration.count() << endl;
-        cout << "  Input size " << size << ": " << duration.count() << " ms" << endl;
+        write_timing_row(results_file_stream, size, stats);
+        results_file_stream << "," << tuned_fft::engine_name(choice.engine) << "," << choice.threads << ","
+            << simd_fft::isa_name(choice.isa) << "," << engine.choice().block << ",";
+        if (tuned) results_file_stream << tuned->time_ms;
+        results_file_stream << "," << max_error << "," << valid << endl;
+        cout << "  Input size " << size << ": " << tuned_fft::describe(engine.choice()) << (tuned ? "" : " (default)")
+            << " "
+            << stats.median_ms << " ms median";
+        if (tuned) cout << " (tuned " << tuned->time_ms << " ms)";
+        cout << ", max error " << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
     }
 
     results_file_stream.close();
-    cout << "Multi-threaded benchmark finished. Results saved to " << output_file_path << endl;
+    cout << "Auto benchmark finished. Results saved to " << output_file_path << endl;
 }
 
+void benchmark::run_scaling_benchmark(const string& output_file_path, unsigned int max_threads)
+{
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create scaling results file: " << output_file_path << endl;
+        return;
+    }
+
+    const timing_harness harness(options);
+
+    // Barrier_* is fft_iterative_multithreaded (one join per stage), Depth_First_* is
+    // fft_depth_first; speedups are over the same engine on one thread, Dispatches are the
+    // pool jobs per transform that woke the workers. Each engine's result is checked on its
+    // own; Valid is 1 when both are within fft_validation::error_bound
+    results_file_stream << "Input_Size,Threads,Barrier_ms,Depth_First_ms,Barrier_Speedup,Depth_First_Speedup,"
+        "Barrier_Dispatches,Depth_First_Dispatches,Barrier_Max_Error,Depth_First_Max_Error,Valid" << endl;
+    cout << "Running scaling benchmark (per-stage barriers vs depth-first, up to " << max_threads << " threads)..."
+        << endl;
+
+    for (int size : SCALING_SIZES)
+    {
+        const vector<complex<double>> input = generate_random_data(size);
+        buffer_arena::buffer buffer = arena->acquire(input.size() * sizeof(complex<double>));
+        span<complex<double>> data = buffer.view<complex<double>>();
+        shared_ptr<const fft_plan> plan = fft_plan::get(size);
+        auto restore = [&] { std::copy(input.begin(), input.end(), data.begin()); };
+
+        double barrier_base_ms = 0.0;
+        double depth_first_base_ms = 0.0;
+        for (unsigned int threads : SCALING_THREADS)
+        {
+            if (threads > max_threads) break;
+            thread_pool& pool = get_pool(threads);
+
+            uint64_t barrier_dispatches = 0;
+            const timing_stats barrier_stats = harness.measure(restore, [&]
+            {
+                const uint64_t before = pool.dispatch_count();
+                fft_iterative_multithreaded(data, *plan, pool);
+                barrier_dispatches = pool.dispatch_count() - before;
+            });
+            const double barrier_error = fft_validation::check_forward(input, data);
+            uint64_t depth_first_dispatches = 0;
+            const timing_stats depth_first_stats = harness.measure(restore, [&]
+            {
+                const uint64_t before = pool.dispatch_count();
+                fft_depth_first(data, *plan, pool);
+                depth_first_dispatches = pool.dispatch_count() - before;
+            });
+            const double depth_first_error = fft_validation::check_forward(input, data);
+            const bool valid = barrier_error <= fft_validation::error_bound(size) &&
+                               depth_first_error <= fft_validation::error_bound(size);
+
+            if (threads == 1)
+            {
+                barrier_base_ms = barrier_stats.median_ms;
+                depth_first_base_ms = depth_first_stats.median_ms;
+            }
+            const double barrier_speedup = barrier_base_ms / barrier_stats.median_ms;
+            const double depth_first_speedup = depth_first_base_ms / depth_first_stats.median_ms;
+
+            results_file_stream << size << "," << threads << "," << barrier_stats.median_ms << ","
+                << depth_first_stats.median_ms << "," << barrier_speedup << "," << depth_first_speedup << ","
+                << barrier_dispatches << "," << depth_first_dispatches << "," << barrier_error << ","
+                << depth_first_error << "," << valid << endl;
+            cout << "  N " << size << ", " << threads << " threads: barrier " << barrier_stats.median_ms << " ms (x"
+                << barrier_speedup << ", " << barrier_dispatches << " dispatches), depth-first "
+                << depth_first_stats.median_ms << " ms (x" << depth_first_speedup << ", " << depth_first_dispatches
+                << " dispatches), max error " << barrier_error << " / " << depth_first_error
+                << (valid ? "" : " FAILED VALIDATION") << endl;
+        }
+    }
 
+    results_file_stream.close();
+    cout << "Scaling benchmark finished. Results saved to " << output_file_path << endl;
+}
 
-unsigned int benchmark::reverse_bits(unsigned int n, unsigned int bits)
+void benchmark::run_distributed_benchmark(const string& output_file_path, unsigned int ranks, simd_isa isa)
 {
-    unsigned int reversed = 0;
-    for (unsigned int i = 0; i < bits; ++i)
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create distributed results file: " << output_file_path << endl;
+        return;
+    }
+
+    const timing_harness harness(options);
+
+    // Wall_ms is the parent's view of one transform, including the workers copying their
+    // slabs in and out; Compute/Reorder/Exchange_ms are the slowest rank's share of each part.
+    // Comm_Fraction is (Reorder + Exchange) / (Compute + Reorder + Exchange), Exchange_MB and
+    // Exchange_GBps the bytes one rank sends to the others per transform and their rate.
+    // Single_Process_ms is fft_iterative over the whole array in this process; its result is
+    // the reference, and Valid is 1 when Max_Error is within fft_validation::error_bound.
+    results_file_stream << "Input_Size,Ranks,Transport,Wall_ms,Compute_ms,Reorder_ms,Exchange_ms,Comm_Fraction,"
+        "Exchange_MB,Exchange_GBps,Single_Process_ms,Max_Error,Valid" << endl;
+    cout << "Running distributed benchmark (" << ranks << " worker processes)..." << endl;
+
+    for (int size : DISTRIBUTED_SIZES)
     {
-        reversed <<= 1;
-        reversed |= (n & 1);
-        n >>= 1;
+        if (!distributed_fft::is_valid(size_t(size), ranks))
+        {
+            cout << "  N " << size << ": cannot be split over " << ranks << " ranks, skipped" << endl;
+            continue;
+        }
+        const vector<complex<double>> input = generate_random_data(size);
+
+        // Reference spectrum and the one-process time in a single pass
+        vector<complex<double>> reference(input.size());
+        shared_ptr<const fft_plan> plan = fft_plan::get(size);
+        const timing_stats single_stats = harness.measure(
+            [&] { std::copy(input.begin(), input.end(), reference.begin()); },
+            [&] { fft_iterative(span<complex<double>>(reference), *plan); });
+
+        const double exchanged_mb =
+            double(distributed_fft::exchanged_elements(size, ranks) * sizeof(complex<double>)) / 1e6;
+        for (transport_kind kind : DISTRIBUTED_TRANSPORTS)
+        {
+            try
+            {
+                distributed_fft_workers workers(size, ranks, kind, isa);
+                std::copy(input.begin(), input.end(), workers.input().begin());
+
+                // The first transform faults in every rank's buffers; keep it out of the part means
+                workers.run();
+                workers.reset_timings();
+                const timing_stats stats = harness.measure([] {}, [&] { workers.run(); });
+                const distributed_timings parts = workers.slowest_rank();
+                const double max_error = fft_validation::relative_error<double>(workers.output(), reference);
+                const bool valid = max_error <= fft_validation::error_bound(size);
+
+                const double total_ms = parts.compute_ms + parts.reorder_ms + parts.exchange_ms;
+                const double comm_fraction = total_ms > 0.0 ? (parts.reorder_ms + parts.exchange_ms) / total_ms : 0.0;
+                const double exchange_gbps = parts.exchange_ms > 0.0 ? exchanged_mb / parts.exchange_ms : 0.0;
+
+                results_file_stream << size << "," << ranks << "," << alltoall_transport::kind_name(kind) << ","
+                    << stats.median_ms << "," << parts.compute_ms << "," << parts.reorder_ms << "," << parts.exchange_ms
+                    << "," << comm_fraction << "," << exchanged_mb << "," << exchange_gbps << ","
+                    << single_stats.median_ms << "," << max_error << "," << valid << endl;
+                cout << "  N " << size << ", " << alltoall_transport::kind_name(kind) << ": " << stats.median_ms
+                    << " ms (compute " << parts.compute_ms << ", reorder " << parts.reorder_ms << ", exchange "
+                    << parts.exchange_ms << " ms; " << comm_fraction * 100.0 << "% communication), one process "
+                    << single_stats.median_ms << " ms, max error " << max_error
+                    << (valid ? "" : " FAILED VALIDATION") << endl;
+            }
+            catch (const exception& e)
+            {
+                cerr << "Distributed benchmark failed: " << e.what() << endl;
+                return;
+            }
+        }
     }
-    return reversed;
+
+    results_file_stream.close();
+    cout << "Distributed benchmark finished. Results saved to " << output_file_path << endl;
 }
 
-void benchmark::fft_iterative(vector<complex<double>>& data)
+void benchmark::run_out_of_core_benchmark(const string& output_file_path, unsigned int num_threads,
+                                          size_t memory_budget_mb)
 {
-    const size_t N = data.size();
-    int logN = 0;
-    while ((1 << logN) < N) ++logN;
+    if (input_file.empty())
+    {
+        cerr << "Out-of-core benchmark needs an input file" << endl;
+        return;
+    }
+    ofstream results_file_stream(output_file_path);
+
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Failed to create out-of-core results file: " << output_file_path << endl;
+        return;
+    }
 
-    for (int i = 0; i < N; ++i)
+    size_t size = 1;
+    const uint64_t samples = mapped_signal(input_file, 0).header().sample_count;
+    while (size * 2 <= samples) size *= 2;
+    const string spectrum_path = output_file_path + ".spectrum.bin";
+
+    try
     {
-        unsigned int reversed_i = reverse_bits(i, logN);
-        if (i < reversed_i)
+        // Panels, plans and twiddle tables are set up outside the timed region
+        out_of_core_fft engine(size, memory_budget_mb << 20);
+        thread_pool& pool = get_pool(num_threads);
+
+        cout << "Running out-of-core benchmark: " << size << " points (" << engine.rows() << " x " << engine.cols()
+            << "), " << memory_budget_mb << " MB budget, panels of " << engine.panel_columns() << " columns / "
+            << engine.panel_rows() << " rows, " << num_threads << " threads..." << endl;
+
+        // Raw sequential disk throughput over the same volume as one pass, capped at 1 GB
+        const size_t probe_bytes = std::min<size_t>(size * sizeof(complex<double>), size_t(1) << 30);
+        const disk_throughput disk =
+            out_of_core_fft::measure_disk_throughput(spectrum_path + ".probe", probe_bytes, size_t(8) << 20);
+
+        // Run and measure. One run, not the harness: every run drops the input from the page
+        // cache and rereads it from disk, so repetitions would only multiply the I/O
+        auto start = chrono::high_resolution_clock::now();
+        const out_of_core_stats stats = engine.execute(input_file, spectrum_path, &pool);
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double, milli> duration = end - start;
+
+        // Validation, after the timed run: against an in-memory fft_iterative when the input
+        // and its transform fit the budget, otherwise against directly computed sampled bins
+        const mapped_signal input_mapping(input_file, size);
+        const mapped_signal spectrum_mapping(spectrum_path, size);
+        const span<const complex<double>> input = input_mapping.complex_samples<double>();
+        const span<const complex<double>> spectrum = spectrum_mapping.complex_samples<double>();
+        double max_error = 0.0;
+        if (2 * size * sizeof(complex<double>) <= (memory_budget_mb << 20))
         {
-            swap(data[i], data[reversed_i]);
+            vector<complex<double>> reference(input.begin(), input.end());
+            fft_iterative(span<complex<double>>(reference), *fft_plan::get(size));
+            max_error = fft_validation::relative_error<double>(spectrum, reference);
         }
+        else
+        {
+            max_error = fft_validation::sampled_bin_error(input, spectrum);
+        }
+        const bool valid = max_error <= fft_validation::error_bound(size);
+
+        // Achieved_MBps counts every byte read and written by both passes; Valid is 1 when
+        // Max_Error is within fft_validation::error_bound
+        const double achieved_mb_per_s = double(stats.bytes_read + stats.bytes_written) / 1e6 / (duration.count() / 1000.0);
+        results_file_stream << "Input_Size,Time_ms,IO_Wait_ms,Memory_Budget_MB,Achieved_MBps,Disk_Read_MBps,"
+            "Disk_Write_MBps,Max_Error,Valid" << endl;
+        results_file_stream << size << "," << duration.count() << "," << stats.io_wait_ms << ","
+            << memory_budget_mb << "," << achieved_mb_per_s << "," << disk.read_mb_per_s << ","
+            << disk.write_mb_per_s << "," << max_error << "," << valid << endl;
+        cout << "  Input size " << size << ": " << duration.count() << " ms (" << stats.io_wait_ms
+            << " ms waiting on I/O), " << achieved_mb_per_s << " MB/s achieved vs disk "
+            << disk.read_mb_per_s << " MB/s read / " << disk.write_mb_per_s << " MB/s write, max error "
+            << max_error << (valid ? "" : " FAILED VALIDATION") << endl;
+    }
+    catch (const exception& e)
+    {
+        cerr << "Out-of-core benchmark failed: " << e.what() << endl;
+        return;
     }
 
-    for (int s = 1; s <= logN; ++s)
+    results_file_stream.close();
+    cout << "Out-of-core benchmark finished. Results saved to " << output_file_path << ", spectrum to "
+        << spectrum_path << endl;
+}
+
+template <typename T>
+void benchmark::fft_iterative(span<complex<type_identity_t<T>>> data, const basic_fft_plan<T>& plan,
+                              fft_phase_observer* observer, size_t tile_bytes)
+{
+    const size_t N = data.size();
+    begin_phase(observer, fft_phase::permute);
+    bit_reversal_permutation::permute(data.data(), N, tile_bytes);
+    end_phase(observer);
+
+    unsigned int stage = 0;
+    for (size_t half = 1; half < N; half <<= 1, ++stage)
     {
-        int m = (1 << s);
-        complex<double> wm = polar(1.0, -2 * M_PI / m);
-        for (int k = 0; k < N; k += m)
+        begin_phase(observer, fft_phase::butterfly, stage);
+        const size_t m = half * 2;
+        const T* w_re = plan.stage_twiddles_re(half);
+        const T* w_im = plan.stage_twiddles_im(half);
+        for (size_t k = 0; k < N; k += m)
         {
-            complex<double> w(1.0, 0);
-            for (int j = 0; j < m / 2; ++j)
+            for (size_t j = 0; j < half; ++j)
             {
-                complex<double> t = w * data[k + j + m / 2];
-                complex<double> u = data[k + j];
+                complex<T> t = complex<T>(w_re[j], w_im[j]) * data[k + j + half];
+                complex<T> u = data[k + j];
                 data[k + j] = u + t;
-                data[k + j + m / 2] = u - t;
-                w *= wm;
+                data[k + j + half] = u - t;
             }
         }
+        end_phase(observer);
     }
 }
 
-void benchmark::fft_iterative_multithreaded(vector<complex<double>>& data, unsigned int num_threads)
+template <typename T>
+void benchmark::fft_iterative_multithreaded(span<complex<type_identity_t<T>>> data, const basic_fft_plan<T>& plan,
+                                            thread_pool& pool, fft_phase_observer* observer, size_t tile_bytes)
 {
     const size_t N = data.size();
     if (N < 2) return;
-    int logN = 0;
-    while ((1 << logN) < N) ++logN;
 
-    auto worker = [&](unsigned int thread_id, std::barrier<>& sync_point)
+    // Enough chunks per participant for stealing to even out the load,
+    // but never so small that a chunk costs less than handing it out
+    const size_t grain = std::max<size_t>(MIN_BUTTERFLIES_PER_TASK, N / 2 / (size_t(pool.size()) * 8));
+
+    // 1. Parallel Bit-Reversal
+    begin_phase(observer, fft_phase::permute);
+    bit_reversal_permutation::permute(data.data(), N, pool, tile_bytes);
+    end_phase(observer);
+
+    // 2. Parallel FFT Stages
+    // Every stage has N/2 independent butterflies, numbered b = group * half + j, and the
+    // pool hands them out in chunks regardless of how they fall into groups. Twiddles
+    // come straight from the plan, so a chunk can start in the middle of a group.
+    unsigned int stage = 0;
+    barrier_reporting barriers(pool, observer, stage);
+    for (size_t half = 1; half < N; half <<= 1, ++stage)
     {
-        // 1. Parallel Bit-Reversal
-        // Each thread handles a chunk of the array.
-        const size_t chunk_size = (N + num_threads - 1) / num_threads;
-        const size_t start_index = thread_id * chunk_size;
-        const size_t end_index = std::min(start_index + chunk_size, N);
+        begin_phase(observer, fft_phase::butterfly, stage);
+        const T* w_re = plan.stage_twiddles_re(half);
+        const T* w_im = plan.stage_twiddles_im(half);
 
-        for (size_t i = start_index; i < end_index; ++i)
+        pool.parallel_for(N / 2, grain, [&](size_t begin, size_t end)
         {
-            unsigned int reversed_i = reverse_bits(i, logN);
-            if (i < reversed_i)
-            {
-                swap(data[i], data[reversed_i]);
-            }
+            butterfly_range(data.data(), half, w_re, w_im, begin, end);
+        });
+        end_phase(observer);
+    }
+}
+
+template void benchmark::fft_iterative<float>(span<complex<float>>, const basic_fft_plan<float>&, fft_phase_observer*,
+                                              size_t);
+template void benchmark::fft_iterative<double>(span<complex<double>>, const basic_fft_plan<double>&,
+                                               fft_phase_observer*, size_t);
+template void benchmark::fft_iterative<long double>(span<complex<long double>>, const basic_fft_plan<long double>&,
+                                                    fft_phase_observer*, size_t);
+template void benchmark::fft_iterative_multithreaded<float>(span<complex<float>>, const basic_fft_plan<float>&,
+                                                            thread_pool&, fft_phase_observer*, size_t);
+template void benchmark::fft_iterative_multithreaded<double>(span<complex<double>>, const basic_fft_plan<double>&,
+                                                             thread_pool&, fft_phase_observer*, size_t);
+template void benchmark::fft_iterative_multithreaded<long double>(span<complex<long double>>,
+                                                                  const basic_fft_plan<long double>&, thread_pool&,
+                                                                  fft_phase_observer*, size_t);
+
+void benchmark::fft_stage(span<complex<double>> data, const fft_plan& plan, size_t half)
+{
+    butterfly_range(data.data(), half, plan.stage_twiddles_re(half), plan.stage_twiddles_im(half), 0,
+                    data.size() / 2);
+}
+
+void benchmark::fft_radix4(span<complex<double>> data, const fft_plan& plan, fft_phase_observer* observer,
+                           size_t tile_bytes)
+{
+    const size_t N = data.size();
+    begin_phase(observer, fft_phase::permute);
+    bit_reversal_permutation::permute(data.data(), N, tile_bytes);
+    end_phase(observer);
+
+    // An odd log2(N) leaves one radix-2 stage; doing it first keeps every later stage radix-4
+    size_t q = 1;
+    unsigned int stage = 0;
+    if (plan.log2_size() % 2 == 1)
+    {
+        begin_phase(observer, fft_phase::butterfly, stage++);
+        for (size_t k = 0; k < N; k += 2)
+        {
+            complex<double> u = data[k];
+            complex<double> t = data[k + 1];
+            data[k] = u + t;
+            data[k + 1] = u - t;
         }
+        end_phase(observer);
+        q = 2;
+    }
+
+    for (; q < N; q *= 4, ++stage)
+    {
+        begin_phase(observer, fft_phase::butterfly, stage);
+        for (size_t k = 0; k < N; k += 4 * q)
+        {
+            radix4_butterflies(data.data(), k, q, 0, q, plan);
+        }
+        end_phase(observer);
+    }
+}
+
+void benchmark::fft_depth_first(span<complex<double>> data, const fft_plan& plan, thread_pool& pool,
+                                fft_phase_observer* observer, size_t max_block)
+{
+    const size_t N = data.size();
+    if (N < 2) return;
+
+    // 1. Parallel Bit-Reversal
+    begin_phase(observer, fft_phase::permute);
+    bit_reversal_permutation::permute(data.data(), N, pool);
+    end_phase(observer);
 
-        sync_point.arrive_and_wait();
+    // 2. Independent blocks, one task each, every stage inside a block done by its participant
+    //    with one join at the end; reported as stage 0
+    size_t block = std::min(N, max_block);
+    while (block > DEPTH_FIRST_LEAF && N / block < size_t(pool.size()) * DEPTH_FIRST_BLOCKS_PER_THREAD)
+    {
+        block /= 2;
+    }
+    unsigned int stage = 0;
+    barrier_reporting barriers(pool, observer, stage);
+    begin_phase(observer, fft_phase::butterfly, stage);
+    pool.parallel_for(N / block, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t b = begin; b < end; ++b)
+        {
+            depth_first_block(data.data() + b * block, block, plan);
+        }
+    });
+    end_phase(observer);
 
-        // 2. Parallel FFT Stages
-        for (int s = 1; s <= logN; ++s)
+    // 3. The stages wider than a block, one join each, as in the iterative kernel
+    const size_t grain = std::max<size_t>(MIN_BUTTERFLIES_PER_TASK, N / 2 / (size_t(pool.size()) * 8));
+    for (size_t half = block; half < N; half <<= 1)
+    {
+        ++stage;
+        begin_phase(observer, fft_phase::butterfly, stage);
+        const double* w_re = plan.stage_twiddles_re(half);
+        const double* w_im = plan.stage_twiddles_im(half);
+        pool.parallel_for(N / 2, grain, [&](size_t begin, size_t end)
         {
-            const int m = (1 << s);
-            const complex<double> wm = polar(1.0, -2 * M_PI / m);
-            const int num_groups = N / m;
+            butterfly_range(data.data(), half, w_re, w_im, begin, end);
+        });
+        end_phase(observer);
+    }
+}
+
+void benchmark::fft_radix4_multithreaded(span<complex<double>> data, const fft_plan& plan, thread_pool& pool,
+                                         fft_phase_observer* observer, size_t tile_bytes)
+{
+    const size_t N = data.size();
+    if (N < 2) return;
+    const size_t grain = std::max<size_t>(MIN_BUTTERFLIES_PER_TASK, N / 4 / (size_t(pool.size()) * 8));
 
-            if (num_groups >= num_threads)
+    begin_phase(observer, fft_phase::permute);
+    bit_reversal_permutation::permute(data.data(), N, pool, tile_bytes);
+    end_phase(observer);
+
+    size_t q = 1;
+    unsigned int stage = 0;
+    barrier_reporting barriers(pool, observer, stage);
+    if (plan.log2_size() % 2 == 1)
+    {
+        begin_phase(observer, fft_phase::butterfly, stage);
+        pool.parallel_for(N / 2, grain, [&](size_t begin, size_t end)
+        {
+            for (size_t b = begin; b < end; ++b)
             {
-                // Strategy 1: Coarse-grained parallelism for early stages
-                for (int group_idx = thread_id; group_idx < num_groups; group_idx += num_threads)
-                {
-                    const int k = group_idx * m;
-                    complex<double> w(1.0, 0);
-                    for (int j = 0; j < m / 2; ++j)
-                    {
-                        complex<double> t = w * data[k + j + m / 2];
-                        complex<double> u = data[k + j];
-                        data[k + j] = u + t;
-                        data[k + j + m / 2] = u - t;
-                        w *= wm;
-                    }
-                }
+                complex<double> u = data[2 * b];
+                complex<double> t = data[2 * b + 1];
+                data[2 * b] = u + t;
+                data[2 * b + 1] = u - t;
             }
-            else
-            {
-                // Strategy 2: Fine-grained parallelism for later stages
-                const int threads_per_group = num_threads / num_groups;
-                const int my_group = thread_id / threads_per_group;
-                const int my_local_thread_id = thread_id % threads_per_group;
-
-                if (my_group < num_groups)
-                {
-                    const int k = my_group * m;
-                    const int butterflies_in_group = m / 2;
-                    const int work_per_local_thread =
-                        (butterflies_in_group + threads_per_group - 1) / threads_per_group;
-                    const int start_j = my_local_thread_id * work_per_local_thread;
-                    const int end_j = std::min(start_j + work_per_local_thread, butterflies_in_group);
+        });
+        end_phase(observer);
+        ++stage;
+        q = 2;
+    }
 
-                    complex<double> w = pow(wm, start_j);
-                    for (int j = start_j; j < end_j; ++j)
-                    {
-                        complex<double> t = w * data[k + j + m / 2];
-                        complex<double> u = data[k + j];
-                        data[k + j] = u + t;
-                        data[k + j + m / 2] = u - t;
-                        w *= wm;
-                    }
-                }
+    // Each stage has N/4 radix-4 butterflies, numbered b = group * q + j as in the radix-2 kernel,
+    // so half as many parallel steps (and joins) as radix-2
+    for (; q < N; q *= 4, ++stage)
+    {
+        begin_phase(observer, fft_phase::butterfly, stage);
+        pool.parallel_for(N / 4, grain, [&](size_t begin, size_t end)
+        {
+            size_t b = begin;
+            while (b < end)
+            {
+                const size_t k = (b / q) * 4 * q;
+                const size_t j_begin = b % q;
+                const size_t j_end = std::min(q, j_begin + (end - b));
+                radix4_butterflies(data.data(), k, q, j_begin, j_end, plan);
+                b += j_end - j_begin;
             }
+        });
+        end_phase(observer);
+    }
+}
 
-            sync_point.arrive_and_wait();
-        }
-    };
+void benchmark::fft_inverse(span<complex<double>> data, const fft_plan& forward_plan, bool normalize)
+{
+    if (forward_plan.direction() != fft_direction::forward || forward_plan.size() != data.size())
+    {
+        throw invalid_argument("fft_inverse: needs the forward plan of the data size");
+    }
+    for (complex<double>& value : data)
+    {
+        value = conj(value);
+    }
+    fft_radix4(data, forward_plan);
+    const double scale = normalize ? 1.0 / double(data.size()) : 1.0;
+    for (complex<double>& value : data)
+    {
+        value = {value.real() * scale, -value.imag() * scale};
+    }
+}
+
+void benchmark::fft_split_radix(span<complex<double>> data, const fft_plan& plan)
+{
+    // The recursion is out of place; the input is copied into a buffer kept per thread
+    thread_local vector<complex<double>> input;
+    input.assign(data.begin(), data.end());
+    split_radix_recursive(input.data(), 1, data.data(), data.size(), plan);
+}
 
-    // Run threads
-    vector<thread> threads;
-    barrier sync_point(num_threads);
-    for (unsigned int i = 0; i < num_threads; ++i)
+void benchmark::split_radix_recursive(const complex<double>* in, size_t stride, complex<double>* out, size_t n,
+                                      const fft_plan& plan)
+{
+    if (n == 1)
+    {
+        out[0] = in[0];
+        return;
+    }
+    if (n == 2)
     {
-        threads.emplace_back(worker, i, std::ref(sync_point));
+        out[0] = in[0] + in[stride];
+        out[1] = in[0] - in[stride];
+        return;
     }
 
-    // Wait for all threads
-    for (auto& thread : threads)
+    // X = U + W^k Z + W^3k Z', where U is the half-length transform of the even samples and
+    // Z, Z' are quarter-length transforms of the samples at 4i + 1 and 4i + 3
+    const size_t quarter = n / 4;
+    split_radix_recursive(in, stride * 2, out, n / 2, plan);
+    split_radix_recursive(in + stride, stride * 4, out + 2 * quarter, quarter, plan);
+    split_radix_recursive(in + 3 * stride, stride * 4, out + 3 * quarter, quarter, plan);
+
+    const fft_direction direction = plan.direction();
+    for (size_t k = 0; k < quarter; ++k)
     {
-        thread.join();
+        const complex<double> z = plan.twiddle(n / 2, k) * out[2 * quarter + k];
+        const complex<double> z3 = stage_twiddle(plan, n, 3 * k) * out[3 * quarter + k];
+        const complex<double> sum = z + z3;
+        const complex<double> diff = rotate_quarter(z - z3, direction);
+
+        const complex<double> u0 = out[k];
+        const complex<double> u1 = out[k + quarter];
+        out[k] = u0 + sum;
+        out[k + 2 * quarter] = u0 - sum;
+        out[k + quarter] = u1 + diff;
+        out[k + 3 * quarter] = u1 - diff;
     }
 }
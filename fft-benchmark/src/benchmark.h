@@ -1,21 +1,192 @@
 #pragma once
 
+#include "bit_reversal.h"
+#include "buffer_arena.h"
+#include "cpu_topology.h"
+#include "fft_plan.h"
+#include "fft_simd.h"
+#include "perf_counters.h"
+#include "signal_file.h"
+#include "stft.h"
+#include "thread_pool.h"
+#include "timing_harness.h"
+
 #include <complex>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 using namespace std;
 
+enum class fft_radix
+{
+    radix2,
+    radix4, // radix-4 stages, plus one radix-2 stage when log2(N) is odd
+    split   // recursive split-radix (single-threaded only)
+};
+
+enum class fft_precision
+{
+    float32,
+    float64,
+    extended // long double
+};
+
 class benchmark {
 public:
     benchmark();
     ~benchmark();
 
-    void run_single_threaded_benchmark(const string& output_file_path);
-    void run_multithreaded_benchmark(const string& output_file_path, unsigned int num_threads);
+    // Single, multi and auto runs transform the first N samples of this binary signal file instead
+    // of random data, skipping sizes the file is too short for; out-of-core runs stream it
+    // from disk. Throws runtime_error when the file cannot be mapped.
+    void set_input_file(const string& path);
+
+    // Where pool threads are pinned in every multithreaded mode; none leaves it to the scheduler
+    void set_affinity_policy(affinity_policy policy) { affinity = policy; }
+
+    // Page size and prefaulting of the transform buffers. Replacing the arena unmaps all its
+    // blocks, so this throws logic_error while any of its buffers is still handed out.
+    void set_arena_options(const arena_options& arena_settings);
+
+    // Warmup, repetition and confidence settings for the single, multi and convolution runs
+    void set_harness_options(const harness_options& harness_settings) { options = harness_settings; }
+
+    // A precision other than float64 runs the radix-2 kernels in that type; its result is
+    // validated in double against the bound for that type's epsilon
+    void run_single_threaded_benchmark(const string& output_file_path, fft_radix radix = fft_radix::radix2,
+                                       fft_precision precision = fft_precision::float64);
+    void run_multithreaded_benchmark(const string& output_file_path, unsigned int num_threads,
+                                     fft_radix radix = fft_radix::radix2,
+                                     fft_precision precision = fft_precision::float64);
+    void run_four_step_benchmark(const string& output_file_path);
+    void run_simd_benchmark(const string& output_file_path, simd_isa isa,
+                            fft_precision precision = fft_precision::float64);
+    void run_mixed_radix_benchmark(const string& output_file_path);
+    void run_real_benchmark(const string& output_file_path);
+    // Streaming FFT convolution (overlap-add and overlap-save) against direct convolution
+    // over a range of filter lengths, to find where the FFT starts to win
+    void run_convolution_benchmark(const string& output_file_path);
+    void run_batch_benchmark(const string& output_file_path, unsigned int num_threads, simd_isa isa);
+    // Streaming STFT over a range of window sizes, overlaps and frame batch sizes: frames/s,
+    // latency from a frame's last sample to its spectrum, and the one-fft_iterative-per-frame baseline
+    void run_stft_benchmark(const string& output_file_path, unsigned int num_threads, simd_isa isa,
+                            window_kind window = window_kind::hann);
+    // 2D and 3D transforms over square and non-square shapes: transposed passes against
+    // strided column passes and one fft_iterative call per row of every axis
+    void run_multidim_benchmark(const string& output_file_path, unsigned int num_threads, simd_isa isa);
+    // Measures every tuned_fft candidate (engine, radix, SIMD kernel, thread count up to
+    // max_threads) at each size and records the fastest valid one for this CPU model in the
+    // wisdom file; one row per candidate
+    void run_tune_benchmark(const string& output_file_path, const string& wisdom_path, unsigned int max_threads,
+                            simd_isa isa);
+    // Runs each size with the choice the wisdom file holds for this CPU model, without
+    // measuring the alternatives; sizes it has no entry for use radix-2 on default_threads
+    void run_auto_benchmark(const string& output_file_path, const string& wisdom_path, unsigned int default_threads);
+    // fft_depth_first against the per-stage barrier kernel on 1, 2, 4, ... 64 threads (up to
+    // max_threads), with each engine's speedup over its own single-thread time
+    void run_scaling_benchmark(const string& output_file_path, unsigned int max_threads);
+    // One transform split over `ranks` worker processes (distributed_fft) for each transport,
+    // with the slowest rank's compute, reorder and exchange time per transform, the bytes each
+    // rank exchanges and the same transform in one process for comparison
+    void run_distributed_benchmark(const string& output_file_path, unsigned int ranks, simd_isa isa);
+    // Transforms the largest power-of-two prefix of the input file on disk within the memory
+    // budget; the spectrum is written to output_file_path + ".spectrum.bin"
+    void run_out_of_core_benchmark(const string& output_file_path, unsigned int num_threads,
+                                   size_t memory_budget_mb);
+
+    // Depth-first blocks of up to this many points (256 KB of complex<double>, within one
+    // core's L2) by default
+    static constexpr size_t DEPTH_FIRST_BLOCK = size_t(1) << 14;
+
+    // Radix-2 kernels for T = float, double and long double; T comes from the plan.
+    // A non-null observer is told where the permutation, each stage and (multithreaded)
+    // each stage's join begin and end; the kernels only branch on it between stages.
+    // tile_bytes bounds the tile of the blocked bit-reversal permutation here and below.
+    template <typename T>
+    static void fft_iterative(span<complex<type_identity_t<T>>> data, const basic_fft_plan<T>& plan,
+                              fft_phase_observer* observer = nullptr,
+                              size_t tile_bytes = bit_reversal_permutation::TILE_BYTES);
+    template <typename T>
+    static void fft_iterative_multithreaded(span<complex<type_identity_t<T>>> data, const basic_fft_plan<T>& plan,
+                                            thread_pool& pool, fft_phase_observer* observer = nullptr,
+                                            size_t tile_bytes = bit_reversal_permutation::TILE_BYTES);
+    // Radix-2 with one join per wide stage only: after the permutation, blocks of up to
+    // max_block points are handed out as independent tasks and transformed depth first to
+    // completion, then the log2(N / block) stages that span blocks run as in the iterative kernel
+    static void fft_depth_first(span<complex<double>> data, const fft_plan& plan, thread_pool& pool,
+                                fft_phase_observer* observer = nullptr, size_t max_block = DEPTH_FIRST_BLOCK);
+    // One radix-2 stage (all N/2 butterflies with half-span `half`) on its own, no permutation;
+    // what the microbenchmarks time per stride
+    static void fft_stage(span<complex<double>> data, const fft_plan& plan, size_t half);
+    static void fft_radix4(span<complex<double>> data, const fft_plan& plan, fft_phase_observer* observer = nullptr,
+                           size_t tile_bytes = bit_reversal_permutation::TILE_BYTES);
+    static void fft_radix4_multithreaded(span<complex<double>> data, const fft_plan& plan, thread_pool& pool,
+                                         fft_phase_observer* observer = nullptr,
+                                         size_t tile_bytes = bit_reversal_permutation::TILE_BYTES);
+    static void fft_split_radix(span<complex<double>> data, const fft_plan& plan);
+    // Inverse transform through a forward plan, IDFT(X) = conj(DFT(conj(X))) / N, so both
+    // directions share one set of twiddle tables. normalize = false leaves out the 1/N,
+    // matching the inverse plans, for callers that fold it in elsewhere.
+    static void fft_inverse(span<complex<double>> data, const fft_plan& forward_plan, bool normalize = true);
+
+    static const char* radix_name(fft_radix radix);
+    static const char* precision_name(fft_precision precision);
+    // Accepts float|double|long-double; returns false for anything else
+    static bool parse_precision(const string& name, fft_precision& precision);
 
 private:
-    static void fft_iterative(vector<complex<double>>& data);
-    static void fft_iterative_multithreaded(vector<complex<double>>& data, unsigned int num_threads);
-    static unsigned int reverse_bits(unsigned int n, unsigned int bits);
+    // Workers are kept parked between transforms and reused across sizes; one pool per
+    // thread count, so the tuner and auto mode can switch counts from size to size
+    thread_pool& get_pool(unsigned int num_threads);
+
+    // The input samples for one size. A complex double input file is mapped and read in place;
+    // any other input format is converted once, outside the timed region. The single, multi
+    // and auto runs restore their arena buffer straight from samples and validate against
+    // them. samples is empty when the input file holds fewer than `size` samples.
+    struct input_frame
+    {
+        unique_ptr<mapped_signal> mapping;
+        vector<complex<double>> storage;
+        span<const complex<double>> samples;
+    };
+    input_frame make_input_frame(int size) const;
+
+    template <typename T>
+    void run_precision_benchmark(const string& output_file_path, thread_pool* pool);
+    template <typename T>
+    void run_simd_precision_benchmark(const string& output_file_path, simd_isa isa);
+
+    static vector<complex<double>> generate_random_data(int size);
+    static void write_timing_row(ostream& out, size_t size, const timing_stats& stats);
+    static void split_radix_recursive(const complex<double>* in, size_t stride, complex<double>* out, size_t n,
+                                      const fft_plan& plan);
+
+    map<unsigned int, unique_ptr<thread_pool>> pools;
+    string input_file;
+    harness_options options;
+    affinity_policy affinity = affinity_policy::none;
+    // Transform buffers, reused across sizes and runs
+    unique_ptr<buffer_arena> arena = make_unique<buffer_arena>();
 };
+
+extern template void benchmark::fft_iterative<float>(span<complex<float>>, const basic_fft_plan<float>&,
+                                                     fft_phase_observer*, size_t);
+extern template void benchmark::fft_iterative<double>(span<complex<double>>, const basic_fft_plan<double>&,
+                                                      fft_phase_observer*, size_t);
+extern template void benchmark::fft_iterative<long double>(span<complex<long double>>,
+                                                           const basic_fft_plan<long double>&, fft_phase_observer*,
+                                                           size_t);
+extern template void benchmark::fft_iterative_multithreaded<float>(span<complex<float>>,
+                                                                   const basic_fft_plan<float>&, thread_pool&,
+                                                                   fft_phase_observer*, size_t);
+extern template void benchmark::fft_iterative_multithreaded<double>(span<complex<double>>,
+                                                                    const basic_fft_plan<double>&, thread_pool&,
+                                                                    fft_phase_observer*, size_t);
+extern template void benchmark::fft_iterative_multithreaded<long double>(span<complex<long double>>,
+                                                                         const basic_fft_plan<long double>&,
+                                                                         thread_pool&, fft_phase_observer*, size_t);
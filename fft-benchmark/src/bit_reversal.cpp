@@ -0,0 +1,36 @@
+#include "bit_reversal.h"
+
+#include <array>
+
+namespace
+{
+    constexpr array<uint8_t, 256> make_byte_table()
+    {
+        array<uint8_t, 256> table{};
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            unsigned int reversed = 0;
+            for (unsigned int bit = 0; bit < 8; ++bit)
+            {
+                reversed |= ((i >> bit) & 1u) << (7 - bit);
+            }
+            table[i] = uint8_t(reversed);
+        }
+        return table;
+    }
+
+    constexpr array<uint8_t, 256> BYTE_REVERSED = make_byte_table();
+}
+
+uint32_t bit_reversal_permutation::reverse(uint32_t x, unsigned int bits)
+{
+    if (bits == 0)
+    {
+        return 0;
+    }
+    const uint32_t reversed = (uint32_t(BYTE_REVERSED[x & 0xff]) << 24) |
+                              (uint32_t(BYTE_REVERSED[(x >> 8) & 0xff]) << 16) |
+                              (uint32_t(BYTE_REVERSED[(x >> 16) & 0xff]) << 8) |
+                              uint32_t(BYTE_REVERSED[x >> 24]);
+    return reversed >> (32 - bits);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// In-place bit-reversal permutation x[i] <-> x[rev(i)] for power-of-two lengths, shared by
+// the radix-2/4 and SIMD kernels and the GPU host code.
+// Small arrays are walked with an incremental reversed counter: no table, O(1) amortized
+// work per index. Once the array no longer fits in cache the swap pattern touches a new
+// line and page on almost every access, so large arrays use the COBRA scheme (Carter and
+// Gatlin): with log2 N = 2q + m, index [a | c | b] (q, m and q bits) maps to
+// [rev b | rev c | rev a]. The 2^q x 2^q elements that share the middle bits c are read
+// row by row into a tile and written row by row into block rev(c), so each pass only
+// keeps 2^q rows open at a time. The tile is at most tile_bytes (TILE_BYTES by default).
+class bit_reversal_permutation {
+public:
+    // One tile; the in-place pass holds two (a block and its partner) at once
+    static constexpr size_t TILE_BYTES = 16384;
+
+    // Reverses the low `bits` bits of x with a 256-entry byte table
+    static uint32_t reverse(uint32_t x, unsigned int bits);
+
+    // Whether n elements take the blocked path, the only one the tile size affects
+    template <typename E>
+    static bool is_blocked(size_t n)
+    {
+        return tile_bits<E>(n, TILE_BYTES) != 0;
+    }
+
+    template <typename E>
+    static void permute(E* data, size_t n, size_t tile_bytes = TILE_BYTES)
+    {
+        const unsigned int q = tile_bits<E>(n, tile_bytes);
+        if (q == 0)
+        {
+            permute_counter(data, n);
+            return;
+        }
+        const unsigned int m = log2_of(n) - 2 * q;
+        permute_blocks(data, q, m, 0, size_t(1) << m);
+    }
+
+    // Middle-bit blocks are spread over the pool; arrays below the blocked threshold run serially
+    template <typename E>
+    static void permute(E* data, size_t n, thread_pool& pool, size_t tile_bytes = TILE_BYTES)
+    {
+        const unsigned int q = tile_bits<E>(n, tile_bytes);
+        if (q == 0)
+        {
+            permute_counter(data, n);
+            return;
+        }
+        const unsigned int m = log2_of(n) - 2 * q;
+        const size_t blocks = size_t(1) << m;
+        const size_t grain = std::max<size_t>(1, blocks / (size_t(pool.size()) * 8));
+        pool.parallel_for(blocks, grain, [&](size_t begin, size_t end)
+        {
+            permute_blocks(data, q, m, begin, end);
+        });
+    }
+
+private:
+    // Arrays up to this many bytes stay in the outer cache levels and use the counter walk
+    static constexpr size_t BLOCKED_MIN_BYTES = size_t(1) << 19;
+
+    static unsigned int log2_of(size_t n)
+    {
+        unsigned int bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        return bits;
+    }
+
+    // q for the blocked pass, or 0 when the counter walk is used
+    template <typename E>
+    static unsigned int tile_bits(size_t n, size_t tile_bytes)
+    {
+        if (n * sizeof(E) <= BLOCKED_MIN_BYTES)
+        {
+            return 0;
+        }
+        unsigned int q = 1;
+        while ((size_t(1) << (2 * (q + 1))) * sizeof(E) <= tile_bytes) ++q;
+        return 2 * q <= log2_of(n) ? q : 0;
+    }
+
+    template <typename E>
+    static void permute_counter(E* data, size_t n)
+    {
+        size_t reversed_i = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i < reversed_i)
+            {
+                swap(data[i], data[reversed_i]);
+            }
+            // rev(i + 1): add one at the top bit and carry downwards
+            size_t bit = n >> 1;
+            while (reversed_i & bit)
+            {
+                reversed_i ^= bit;
+                bit >>= 1;
+            }
+            reversed_i |= bit;
+        }
+    }
+
+    // Exchanges every block c in [c_begin, c_end) with block rev(c); each pair is handled
+    // once, by its smaller index, so disjoint ranges can run concurrently
+    template <typename E>
+    static void permute_blocks(E* data, unsigned int q, unsigned int m, size_t c_begin, size_t c_end)
+    {
+        const size_t side = size_t(1) << q;
+        const unsigned int high_shift = q + m;
+
+        thread_local vector<E> tiles;
+        thread_local vector<uint32_t> reversed_q;
+        tiles.resize(2 * side * side);
+        reversed_q.resize(side);
+        for (size_t i = 0; i < side; ++i)
+        {
+            reversed_q[i] = reverse(uint32_t(i), q);
+        }
+
+        // tile[rev a][b] = X[a | c | b]: contiguous rows in, contiguous rows out
+        auto load = [&](E* tile, size_t c)
+        {
+            for (size_t a = 0; a < side; ++a)
+            {
+                const E* row = data + (a << high_shift) + (c << q);
+                std::copy(row, row + side, tile + size_t(reversed_q[a]) * side);
+            }
+        };
+        // X[rev b | c | a'] = tile[a'][b]
+        auto store = [&](const E* tile, size_t c)
+        {
+            for (size_t b = 0; b < side; ++b)
+            {
+                E* row = data + (size_t(reversed_q[b]) << high_shift) + (c << q);
+                for (size_t a = 0; a < side; ++a)
+                {
+                    row[a] = tile[a * side + b];
+                }
+            }
+        };
+
+        E* tile = tiles.data();
+        E* partner_tile = tile + side * side;
+        for (size_t c = c_begin; c < c_end; ++c)
+        {
+            const size_t reversed_c = reverse(uint32_t(c), m);
+            if (reversed_c < c)
+            {
+                continue;
+            }
+            load(tile, c);
+            if (reversed_c != c)
+            {
+                load(partner_tile, reversed_c);
+                store(partner_tile, c);
+            }
+            store(tile, reversed_c);
+        }
+    }
+};
@@ -0,0 +1,224 @@
+#include "buffer_arena.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+namespace
+{
+    constexpr size_t SMALL_PAGE = size_t(4) << 10;
+    constexpr size_t HUGE_PAGE = size_t(2) << 20;
+
+    size_t round_up(size_t value, size_t multiple)
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+}
+
+buffer_arena::buffer::buffer(buffer&& other) noexcept
+    : owner(other.owner), block(other.block), memory(other.memory), length(other.length)
+{
+    other.owner = nullptr;
+}
+
+buffer_arena::buffer& buffer_arena::buffer::operator=(buffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        owner = other.owner;
+        block = other.block;
+        memory = other.memory;
+        length = other.length;
+        other.owner = nullptr;
+    }
+    return *this;
+}
+
+buffer_arena::buffer::~buffer()
+{
+    release();
+}
+
+void buffer_arena::buffer::release()
+{
+    if (owner)
+    {
+        owner->blocks[block].in_use = false;
+        owner = nullptr;
+    }
+}
+
+buffer_arena::buffer_arena(arena_options arena_settings)
+    : options(arena_settings), current_pages(arena_settings.pages)
+{
+}
+
+buffer_arena::~buffer_arena()
+{
+    for (block& entry : blocks)
+    {
+        unmap_block(entry);
+    }
+}
+
+buffer_arena::buffer buffer_arena::acquire(size_t bytes, thread_pool* pool)
+{
+    bytes = std::max<size_t>(bytes, ALIGNMENT);
+
+    // 1. The smallest free block that fits
+    size_t best = blocks.size();
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (!blocks[i].in_use && blocks[i].mapping && blocks[i].capacity >= bytes &&
+            (best == blocks.size() || blocks[i].capacity < blocks[best].capacity))
+        {
+            best = i;
+        }
+    }
+    if (best < blocks.size())
+    {
+        blocks[best].in_use = true;
+        return buffer(this, best, blocks[best].memory, bytes);
+    }
+
+    // 2. Otherwise drop the free blocks that are too small and map a new one in a free slot
+    size_t slot = blocks.size();
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (!blocks[i].in_use)
+        {
+            unmap_block(blocks[i]);
+            if (slot == blocks.size()) slot = i;
+        }
+    }
+    if (slot == blocks.size())
+    {
+        blocks.emplace_back();
+    }
+    map_block(blocks[slot], bytes);
+    if (options.prefault)
+    {
+        prefault(blocks[slot], pool);
+    }
+    blocks[slot].in_use = true;
+    return buffer(this, slot, blocks[slot].memory, bytes);
+}
+
+void buffer_arena::map_block(block& target, size_t bytes)
+{
+    if (current_pages == page_mode::huge_tlb)
+    {
+        const size_t length = round_up(bytes, HUGE_PAGE);
+        void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                             -1, 0);
+        if (mapping != MAP_FAILED)
+        {
+            target = {mapping, length, mapping, length, false};
+            return;
+        }
+        cerr << "buffer_arena: MAP_HUGETLB failed (" << strerror(errno)
+            << "; reserve pages in /proc/sys/vm/nr_hugepages), using transparent huge pages" << endl;
+        current_pages = page_mode::transparent_huge;
+    }
+
+    // Transparent huge pages need a 2 MiB-aligned range, so map one huge page extra and trim
+    const bool huge = current_pages == page_mode::transparent_huge;
+    const size_t capacity = round_up(bytes, huge ? HUGE_PAGE : SMALL_PAGE);
+    const size_t length = capacity + (huge ? HUGE_PAGE : 0);
+    void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        throw runtime_error("buffer_arena: cannot map " + to_string(length) + " bytes: " + strerror(errno));
+    }
+    char* start = static_cast<char*>(mapping);
+    if (huge)
+    {
+        start = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(start), HUGE_PAGE));
+        madvise(start, capacity, MADV_HUGEPAGE);
+    }
+    target = {mapping, length, start, capacity, false};
+}
+
+void buffer_arena::prefault(const block& target, thread_pool* pool) const
+{
+    // One write per small page is enough to fault it in; with THP the first write into each
+    // 2 MiB range allocates the huge page
+    char* base = static_cast<char*>(target.memory);
+    const size_t pages = target.capacity / SMALL_PAGE;
+    auto touch = [&](size_t first, size_t last)
+    {
+        for (size_t page = first; page < last; ++page)
+        {
+            base[page * SMALL_PAGE] = 0;
+        }
+    };
+
+    if (pool == nullptr || pool->size() == 1)
+    {
+        touch(0, pages);
+        return;
+    }
+    const size_t participants = pool->size();
+    pool->parallel_for(participants, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t share = begin; share < end; ++share)
+        {
+            touch(pages * share / participants, pages * (share + 1) / participants);
+        }
+    });
+}
+
+void buffer_arena::unmap_block(block& target)
+{
+    if (target.mapping)
+    {
+        munmap(target.mapping, target.mapping_length);
+    }
+    target = {};
+}
+
+size_t buffer_arena::mapped_bytes() const
+{
+    size_t total = 0;
+    for (const block& entry : blocks)
+    {
+        total += entry.mapping_length;
+    }
+    return total;
+}
+
+size_t buffer_arena::buffers_in_use() const
+{
+    return size_t(std::count_if(blocks.begin(), blocks.end(), [](const block& entry) { return entry.in_use; }));
+}
+
+const char* buffer_arena::page_mode_name(page_mode mode)
+{
+    switch (mode)
+    {
+    case page_mode::transparent_huge: return "thp";
+    case page_mode::huge_tlb: return "hugetlb";
+    default: return "4k";
+    }
+}
+
+bool buffer_arena::parse_page_mode(const string& name, page_mode& mode)
+{
+    for (page_mode candidate : {page_mode::small, page_mode::transparent_huge, page_mode::huge_tlb})
+    {
+        if (name == page_mode_name(candidate))
+        {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
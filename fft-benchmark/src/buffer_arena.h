@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class thread_pool;
+
+enum class page_mode
+{
+    small,            // 4 KiB pages
+    transparent_huge, // 2 MiB-aligned mapping with MADV_HUGEPAGE; the kernel may still use 4 KiB pages
+    huge_tlb          // MAP_HUGETLB from the reserved pool; falls back to transparent_huge when it is empty
+};
+
+struct arena_options
+{
+    page_mode pages = page_mode::small;
+    // Touch every page of a new block when it is handed out, so page faults and huge-page
+    // allocation happen there and not in the first timed run
+    bool prefault = true;
+};
+
+// Transform buffers that outlive one size or one benchmark run. Every block is its own
+// anonymous mapping, so buffers are page aligned (at least ALIGNMENT bytes). A released
+// block goes back to the arena and is handed out again for any request it is big enough
+// for; when a new block is needed, free blocks too small for the request are unmapped
+// first, since the benchmarks walk sizes upwards and would never reuse them.
+class buffer_arena {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    // A block on loan from the arena, returned when the buffer is destroyed
+    class buffer {
+    public:
+        buffer() = default;
+        buffer(buffer&& other) noexcept;
+        buffer& operator=(buffer&& other) noexcept;
+        ~buffer();
+
+        void* data() const { return memory; }
+        size_t size() const { return length; }
+
+        template <typename T>
+        span<T> view() const { return span<T>(static_cast<T*>(memory), length / sizeof(T)); }
+
+    private:
+        friend class buffer_arena;
+        buffer(buffer_arena* arena, size_t block_index, void* data, size_t bytes)
+            : owner(arena), block(block_index), memory(data), length(bytes) {}
+        void release();
+
+        buffer_arena* owner = nullptr;
+        size_t block = 0;
+        void* memory = nullptr;
+        size_t length = 0;
+    };
+
+    explicit buffer_arena(arena_options options = {});
+    ~buffer_arena();
+
+    buffer_arena(const buffer_arena&) = delete;
+    buffer_arena& operator=(const buffer_arena&) = delete;
+
+    // At least `bytes` of uninitialised (or, prefaulted, zeroed) memory. With a pool, a new
+    // block is prefaulted share by share: share i of P is touched by the participant that
+    // parallel_for hands chunk i to, which under Linux's first-touch policy puts each share
+    // on its worker's NUMA node. Throws runtime_error when the mapping fails.
+    buffer acquire(size_t bytes, thread_pool* pool = nullptr);
+
+    const arena_options& settings() const { return options; }
+    // Page mode actually in use (huge_tlb falls back after the first failed mapping)
+    page_mode pages() const { return current_pages; }
+    size_t mapped_bytes() const;
+    // Buffers handed out and not yet destroyed
+    size_t buffers_in_use() const;
+
+    static const char* page_mode_name(page_mode mode);
+    // Accepts 4k|thp|hugetlb; returns false for anything else
+    static bool parse_page_mode(const string& name, page_mode& mode);
+
+private:
+    struct block
+    {
+        void* mapping = nullptr;  // what munmap gets
+        size_t mapping_length = 0;
+        void* memory = nullptr;   // aligned start handed out
+        size_t capacity = 0;
+        bool in_use = false;
+    };
+
+    void map_block(block& target, size_t bytes);
+    void prefault(const block& target, thread_pool* pool) const;
+    static void unmap_block(block& target);
+
+    arena_options options;
+    page_mode current_pages;
+    vector<block> blocks;
+};
@@ -0,0 +1,241 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace
+{
+    const string CPU_ROOT = "/sys/devices/system/cpu/";
+    const string NODE_ROOT = "/sys/devices/system/node/";
+
+    int read_int(const string& path, int fallback)
+    {
+        ifstream file(path);
+        int value;
+        return (file >> value) ? value : fallback;
+    }
+
+    // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+    vector<int> parse_cpu_list(const string& list)
+    {
+        vector<int> result;
+        size_t pos = 0;
+        while (pos < list.size())
+        {
+            size_t end = list.find(',', pos);
+            if (end == string::npos) end = list.size();
+            const string range = list.substr(pos, end - pos);
+            const size_t dash = range.find('-');
+            try
+            {
+                const int first = stoi(range.substr(0, dash));
+                const int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) result.push_back(cpu);
+            } catch (const std::exception&)
+            {
+                // Trailing newline or an empty list
+            }
+            pos = end + 1;
+        }
+        return result;
+    }
+
+    // First sibling of every core, ordered by node, package and core
+    vector<int> first_siblings(const vector<logical_cpu>& cpus)
+    {
+        vector<int> result;
+        for (const logical_cpu& cpu : cpus)
+        {
+            if (cpu.sibling == 0) result.push_back(cpu.id);
+        }
+        return result;
+    }
+}
+
+cpu_topology::cpu_topology()
+{
+    // 1. CPUs this process may run on
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    const bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    // 2. Node of every CPU
+    map<int, int> cpu_node;
+    error_code ec;
+    for (const auto& entry : filesystem::directory_iterator(NODE_ROOT, ec))
+    {
+        const string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !isdigit(name[4])) continue;
+        ifstream file(entry.path() / "cpulist");
+        string list;
+        getline(file, list);
+        for (int cpu : parse_cpu_list(list))
+        {
+            cpu_node[cpu] = stoi(name.substr(4));
+        }
+    }
+
+    // 3. Package and core of every online CPU we may use
+    ifstream online_file(CPU_ROOT + "online");
+    string online;
+    getline(online_file, online);
+    for (int id : parse_cpu_list(online))
+    {
+        if (have_mask && !CPU_ISSET(id, &allowed)) continue;
+        logical_cpu cpu;
+        cpu.id = id;
+        const string topology = CPU_ROOT + "cpu" + to_string(id) + "/topology/";
+        cpu.package = read_int(topology + "physical_package_id", 0);
+        cpu.core = read_int(topology + "core_id", id);
+        cpu.node = cpu_node.count(id) ? cpu_node[id] : 0;
+        logical_cpus.push_back(cpu);
+    }
+    if (logical_cpus.empty())
+    {
+        logical_cpus.push_back(logical_cpu{});
+    }
+
+    // 4. Order and number the SMT siblings of each core
+    sort(logical_cpus.begin(), logical_cpus.end(), [](const logical_cpu& a, const logical_cpu& b)
+    {
+        if (a.node != b.node) return a.node < b.node;
+        if (a.package != b.package) return a.package < b.package;
+        if (a.core != b.core) return a.core < b.core;
+        return a.id < b.id;
+    });
+    set<int> node_ids;
+    set<int> package_ids;
+    for (size_t i = 0; i < logical_cpus.size(); ++i)
+    {
+        logical_cpu& cpu = logical_cpus[i];
+        const bool same_core = i > 0 && logical_cpus[i - 1].package == cpu.package && logical_cpus[i - 1].core == cpu.core;
+        cpu.sibling = same_core ? logical_cpus[i - 1].sibling + 1 : 0;
+        node_ids.insert(cpu.node);
+        package_ids.insert(cpu.package);
+    }
+    nodes = node_ids.size();
+    packages = package_ids.size();
+    cores = first_siblings(logical_cpus).size();
+}
+
+int cpu_topology::node_of(int cpu) const
+{
+    for (const logical_cpu& candidate : logical_cpus)
+    {
+        if (candidate.id == cpu) return candidate.node;
+    }
+    return 0;
+}
+
+vector<int> cpu_topology::placement(affinity_policy policy, unsigned int count) const
+{
+    vector<int> order;
+    switch (policy)
+    {
+    case affinity_policy::none:
+        return {};
+    case affinity_policy::compact:
+        for (const logical_cpu& cpu : logical_cpus) order.push_back(cpu.id);
+        break;
+    case affinity_policy::physical:
+        order = first_siblings(logical_cpus);
+        if (count > order.size())
+        {
+            throw invalid_argument("physical placement needs at most " + to_string(order.size()) +
+                                   " threads (one per physical core), got " + to_string(count));
+        }
+        break;
+    case affinity_policy::scatter:
+    {
+        // Sibling level by sibling level; within a level, cores round-robin across nodes
+        int max_sibling = 0;
+        for (const logical_cpu& cpu : logical_cpus) max_sibling = std::max(max_sibling, cpu.sibling);
+        for (int sibling = 0; sibling <= max_sibling; ++sibling)
+        {
+            map<int, vector<int>> per_node;
+            for (const logical_cpu& cpu : logical_cpus)
+            {
+                if (cpu.sibling == sibling) per_node[cpu.node].push_back(cpu.id);
+            }
+            for (size_t i = 0, added = 1; added > 0; ++i)
+            {
+                added = 0;
+                for (const auto& [node, cpus] : per_node)
+                {
+                    if (i < cpus.size())
+                    {
+                        order.push_back(cpus[i]);
+                        ++added;
+                    }
+                }
+            }
+        }
+        break;
+    }
+    }
+
+    vector<int> result(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        result[i] = order[i % order.size()];
+    }
+    return result;
+}
+
+string cpu_topology::model_name()
+{
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line))
+    {
+        const size_t colon = line.find(':');
+        if (colon == string::npos || line.compare(0, 10, "model name") != 0) continue;
+        size_t begin = colon + 1;
+        while (begin < line.size() && isspace(static_cast<unsigned char>(line[begin]))) ++begin;
+        size_t end = line.size();
+        while (end > begin && isspace(static_cast<unsigned char>(line[end - 1]))) --end;
+        return line.substr(begin, end - begin);
+    }
+    return "unknown";
+}
+
+bool cpu_topology::pin_current_thread(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+const char* cpu_topology::policy_name(affinity_policy policy)
+{
+    switch (policy)
+    {
+    case affinity_policy::compact: return "compact";
+    case affinity_policy::scatter: return "scatter";
+    case affinity_policy::physical: return "physical";
+    default: return "none";
+    }
+}
+
+bool cpu_topology::parse_policy(const string& name, affinity_policy& policy)
+{
+    for (affinity_policy candidate : {affinity_policy::none, affinity_policy::compact, affinity_policy::scatter,
+                                      affinity_policy::physical})
+    {
+        if (name == policy_name(candidate))
+        {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
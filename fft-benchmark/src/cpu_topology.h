@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Where the thread pool puts its participants
+enum class affinity_policy
+{
+    none,     // leave placement to the scheduler
+    compact,  // fill a core's SMT siblings, then the next core, then the next node
+    scatter,  // one thread per core, round-robin across nodes, siblings only once every core is busy
+    physical  // one thread per physical core, never two on one core (SMT off without rebooting)
+};
+
+struct logical_cpu
+{
+    int id = 0;
+    int package = 0;
+    int core = 0;  // core_id, unique within its package
+    int node = 0;
+    int sibling = 0; // 0 for the first hardware thread of its core, 1 for the second, ...
+};
+
+// The CPUs this process may run on, read from /sys/devices/system/cpu and
+// /sys/devices/system/node and filtered by the inherited affinity mask (so a run under
+// taskset or a cpuset only sees its own CPUs). Missing node information means one node.
+class cpu_topology {
+public:
+    cpu_topology();
+
+    const vector<logical_cpu>& cpus() const { return logical_cpus; }
+    size_t node_count() const { return nodes; }
+    size_t package_count() const { return packages; }
+    size_t core_count() const { return cores; }
+    int node_of(int cpu) const;
+
+    // CPU for each of `count` participants, participant 0 first; empty for affinity_policy::none.
+    // compact and scatter wrap around once every CPU has a thread; physical throws
+    // invalid_argument when count exceeds the number of physical cores.
+    vector<int> placement(affinity_policy policy, unsigned int count) const;
+
+    // "model name" of the first processor in /proc/cpuinfo, "unknown" when there is none
+    static string model_name();
+
+    // Restricts the calling thread to one CPU; false when the kernel refuses
+    static bool pin_current_thread(int cpu);
+
+    static const char* policy_name(affinity_policy policy);
+    // Accepts none|compact|scatter|physical; returns false for anything else
+    static bool parse_policy(const string& name, affinity_policy& policy);
+
+private:
+    vector<logical_cpu> logical_cpus; // sorted by node, package, core, sibling
+    size_t nodes = 1;
+    size_t packages = 1;
+    size_t cores = 1;
+};
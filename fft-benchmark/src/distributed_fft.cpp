@@ -0,0 +1,398 @@
+#include "distributed_fft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <numbers>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    // Tiles of the local pack, as in the multidim and four-step transposes
+    constexpr size_t TRANSPOSE_BLOCK = 32;
+
+    // How often a waiting parent checks whether a worker has died
+    constexpr chrono::milliseconds SUPERVISION_INTERVAL(20);
+    // How long the destructor lets parked workers exit before killing them
+    constexpr chrono::seconds STOP_TIMEOUT(5);
+
+    // dst[c * dst_stride + r] = src[r * src_stride + c] for r < rows, c < cols
+    void transpose_tiles(const complex<double>* src, size_t src_stride, complex<double>* dst, size_t dst_stride,
+                         size_t rows, size_t cols)
+    {
+        for (size_t rb = 0; rb < rows; rb += TRANSPOSE_BLOCK)
+        {
+            const size_t r_end = std::min(rb + TRANSPOSE_BLOCK, rows);
+            for (size_t cb = 0; cb < cols; cb += TRANSPOSE_BLOCK)
+            {
+                const size_t c_end = std::min(cb + TRANSPOSE_BLOCK, cols);
+                for (size_t r = rb; r < r_end; ++r)
+                {
+                    for (size_t c = cb; c < c_end; ++c)
+                    {
+                        dst[c * dst_stride + r] = src[r * src_stride + c];
+                    }
+                }
+            }
+        }
+    }
+
+    double elapsed_ms(chrono::steady_clock::time_point since)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+    }
+
+    unsigned int log2_of(size_t n)
+    {
+        unsigned int bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        return bits;
+    }
+}
+
+distributed_fft::distributed_fft(size_t size, unsigned int rank_index, alltoall_transport& all_to_all, simd_isa isa)
+    : n(size), n1(size_t(1) << (log2_of(size) / 2)), n2(size / n1), rank(rank_index),
+      ranks(all_to_all.ranks()), slab(size / all_to_all.ranks()), transport(all_to_all),
+      column_engine(n1, fft_direction::forward, isa), row_engine(n2, fft_direction::forward, isa)
+{
+    if (!is_valid(size, ranks))
+    {
+        throw invalid_argument("distributed_fft: N must be a power of two and P a power of two no larger than "
+                               "2^floor(log2(N) / 2)");
+    }
+    if (transport.block_size() != slab / ranks)
+    {
+        throw invalid_argument("distributed_fft: the transport's block size must be N / P^2");
+    }
+
+    // This rank's rows n2 of the n2 x n1 matrix, one twiddle per column k1
+    const size_t rows = n2 / ranks;
+    twiddles.resize(rows * n1);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const size_t index = size_t(rank) * rows + row;
+        for (size_t k1 = 0; k1 < n1; ++k1)
+        {
+            const long double turns = static_cast<long double>(index * k1 % n) / n;
+            const long double angle = -2.0L * numbers::pi_v<long double> * turns;
+            twiddles[row * n1 + k1] = complex<double>(double(cosl(angle)), double(sinl(angle)));
+        }
+    }
+    incoming.resize(slab);
+}
+
+bool distributed_fft::is_valid(size_t size, unsigned int ranks)
+{
+    if (size < 4 || (size & (size - 1)) != 0 || ranks == 0 || (ranks & (ranks - 1)) != 0) return false;
+    return ranks <= (size_t(1) << (log2_of(size) / 2));
+}
+
+size_t distributed_fft::exchanged_elements(size_t size, unsigned int ranks)
+{
+    return 3 * (size / ranks) / ranks * (ranks - 1);
+}
+
+void distributed_fft::transpose(complex<double>* data, size_t rows, size_t cols)
+{
+    // Rank r holds rows [r R, (r+1) R) and ends up with rows [r C, (r+1) C) of the transpose
+    const size_t local_rows = rows / ranks;
+    const size_t local_cols = cols / ranks;
+    const size_t block = local_rows * local_cols;
+
+    auto start = chrono::steady_clock::now();
+    complex<double>* send = transport.send_buffer(rank);
+    for (unsigned int target = 0; target < ranks; ++target)
+    {
+        transpose_tiles(data + size_t(target) * local_cols, cols, send + size_t(target) * block, local_rows,
+                        local_rows, local_cols);
+    }
+    spent.reorder_ms += elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    transport.exchange(rank, incoming.data());
+    spent.exchange_ms += elapsed_ms(start);
+
+    // Block i is columns [i R, (i+1) R) of every row this rank now owns
+    start = chrono::steady_clock::now();
+    for (unsigned int source = 0; source < ranks; ++source)
+    {
+        const complex<double>* from = incoming.data() + size_t(source) * block;
+        for (size_t c = 0; c < local_cols; ++c)
+        {
+            std::copy(from + c * local_rows, from + (c + 1) * local_rows,
+                      data + c * rows + size_t(source) * local_rows);
+        }
+    }
+    spent.reorder_ms += elapsed_ms(start);
+}
+
+void distributed_fft::execute(complex<double>* data)
+{
+    // n1 x n2 by rows -> n2 x n1: every rank now owns whole columns of the input
+    transpose(data, n1, n2);
+
+    auto start = chrono::steady_clock::now();
+    column_engine.execute(data, n2 / ranks);
+    for (size_t i = 0; i < slab; ++i)
+    {
+        data[i] *= twiddles[i];
+    }
+    spent.compute_ms += elapsed_ms(start);
+
+    transpose(data, n2, n1);
+
+    start = chrono::steady_clock::now();
+    row_engine.execute(data, n1 / ranks);
+    spent.compute_ms += elapsed_ms(start);
+
+    // X[k1 + n1 k2] sits at [k1][k2]; the last transpose puts it back in natural order
+    transpose(data, n1, n2);
+}
+
+struct distributed_fft_workers::control
+{
+    sem_t done; // posted by each rank at the end of a transform
+    int stopping;
+};
+
+distributed_fft_workers::distributed_fft_workers(size_t size, unsigned int num_ranks, transport_kind kind,
+                                                 simd_isa isa)
+    : n(size), ranks(num_ranks), timings_at_reset(num_ranks)
+{
+    if (!distributed_fft::is_valid(size, num_ranks))
+    {
+        throw invalid_argument("distributed_fft_workers: " + to_string(num_ranks) + " ranks cannot split " +
+                               to_string(size) + " points");
+    }
+
+    // Shared with the workers through fork: input and output, then semaphores and timings
+    void* arrays = mmap(nullptr, 2 * n * sizeof(complex<double>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                        -1, 0);
+    if (arrays == MAP_FAILED)
+    {
+        throw runtime_error(string("distributed_fft_workers: cannot map the shared arrays: ") + strerror(errno));
+    }
+    data = static_cast<complex<double>*>(arrays);
+
+    control_bytes = sizeof(control) + ranks * (sizeof(distributed_timings) + sizeof(sem_t));
+    void* block = mmap(nullptr, control_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED)
+    {
+        munmap(data, 2 * n * sizeof(complex<double>));
+        throw runtime_error(string("distributed_fft_workers: cannot map the control block: ") + strerror(errno));
+    }
+    shared = static_cast<control*>(block);
+    std::fill(rank_timings(), rank_timings() + ranks, distributed_timings{});
+
+    // Each rank waits on its own semaphore, so a fast rank cannot take another's start
+    sem_init(&shared->done, 1, 0);
+    for (unsigned int rank = 0; rank < ranks; ++rank)
+    {
+        sem_init(&start_semaphores()[rank], 1, 0);
+    }
+    shared->stopping = 0;
+
+    auto release = [&] {
+        for (unsigned int rank = 0; rank < ranks; ++rank)
+        {
+            sem_destroy(&start_semaphores()[rank]);
+        }
+        sem_destroy(&shared->done);
+        munmap(shared, control_bytes);
+        munmap(data, 2 * n * sizeof(complex<double>));
+    };
+
+    try
+    {
+        transport = alltoall_transport::create(kind, ranks, n / ranks / ranks);
+    } catch (...)
+    {
+        release();
+        throw;
+    }
+
+    // Nothing buffered may be written twice, once by each process
+    cout.flush();
+    cerr.flush();
+    const pid_t parent = getpid();
+    for (unsigned int rank = 0; rank < ranks; ++rank)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            // Rank 0 leads the group; the parent makes the same call, whichever runs first
+            setpgid(0, group);
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (getppid() != parent) _exit(1);
+            transport->keep_rank(rank);
+            try
+            {
+                worker_main(rank, isa);
+            } catch (const std::exception& e)
+            {
+                cerr << "distributed_fft_workers: rank " << rank << ": " << e.what() << endl;
+                _exit(1);
+            }
+            _exit(0);
+        }
+        if (pid < 0)
+        {
+            const string error = strerror(errno);
+            kill_workers();
+            release();
+            throw runtime_error("distributed_fft_workers: cannot fork rank " + to_string(rank) + ": " + error);
+        }
+        setpgid(pid, group);
+        if (group == 0) group = pid;
+        workers.push_back(pid);
+    }
+    transport->keep_rank(ranks);
+}
+
+distributed_fft_workers::~distributed_fft_workers()
+{
+    // Parked workers see the flag and return; one that is gone or stuck is killed with the rest
+    shared->stopping = 1;
+    for (unsigned int rank = 0; rank < ranks; ++rank)
+    {
+        sem_post(&start_semaphores()[rank]);
+    }
+    const auto deadline = chrono::steady_clock::now() + STOP_TIMEOUT;
+    for (pid_t& worker : workers)
+    {
+        while (worker != 0 && chrono::steady_clock::now() < deadline)
+        {
+            if (waitpid(worker, nullptr, WNOHANG) != 0) worker = 0;
+            else this_thread::sleep_for(SUPERVISION_INTERVAL);
+        }
+    }
+    kill_workers();
+
+    for (unsigned int rank = 0; rank < ranks; ++rank)
+    {
+        sem_destroy(&start_semaphores()[rank]);
+    }
+    sem_destroy(&shared->done);
+    munmap(shared, control_bytes);
+    munmap(data, 2 * n * sizeof(complex<double>));
+}
+
+distributed_timings* distributed_fft_workers::rank_timings() const
+{
+    return reinterpret_cast<distributed_timings*>(shared + 1);
+}
+
+sem_t* distributed_fft_workers::start_semaphores() const
+{
+    return reinterpret_cast<sem_t*>(rank_timings() + ranks);
+}
+
+void distributed_fft_workers::check_workers()
+{
+    for (size_t rank = 0; rank < workers.size(); ++rank)
+    {
+        int status = 0;
+        if (workers[rank] == 0 || waitpid(workers[rank], &status, WNOHANG) == 0) continue;
+        workers[rank] = 0;
+        kill_workers();
+        const string how = WIFSIGNALED(status) ? "was killed by signal " + to_string(WTERMSIG(status))
+                                               : "exited with status " + to_string(WEXITSTATUS(status));
+        throw runtime_error("distributed_fft_workers: rank " + to_string(rank) + " " + how);
+    }
+}
+
+void distributed_fft_workers::kill_workers()
+{
+    if (std::any_of(workers.begin(), workers.end(), [](pid_t worker) { return worker != 0; }))
+    {
+        kill(-group, SIGKILL);
+    }
+    for (pid_t& worker : workers)
+    {
+        if (worker != 0) waitpid(worker, nullptr, 0);
+        worker = 0;
+    }
+}
+
+void distributed_fft_workers::worker_main(unsigned int rank, simd_isa isa)
+{
+    distributed_fft engine(n, rank, *transport, isa);
+    vector<complex<double>> local(engine.slab_size());
+    const size_t offset = size_t(rank) * engine.slab_size();
+
+    for (;;)
+    {
+        if (sem_wait(&start_semaphores()[rank]) != 0) continue; // interrupted by a signal
+        if (shared->stopping) return;
+
+        std::copy(data + offset, data + offset + local.size(), local.begin());
+        engine.execute(local.data());
+        std::copy(local.begin(), local.end(), data + n + offset);
+        rank_timings()[rank] = engine.timings();
+
+        sem_post(&shared->done);
+    }
+}
+
+void distributed_fft_workers::run()
+{
+    if (std::find(workers.begin(), workers.end(), 0) != workers.end())
+    {
+        throw runtime_error("distributed_fft_workers: the workers have been stopped after a failure");
+    }
+    for (unsigned int rank = 0; rank < ranks; ++rank)
+    {
+        sem_post(&start_semaphores()[rank]);
+    }
+    // Block on the semaphore, but wake up now and then to see whether a worker has died
+    for (unsigned int finished = 0; finished < ranks;)
+    {
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += long(chrono::nanoseconds(SUPERVISION_INTERVAL).count());
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        if (sem_timedwait(&shared->done, &deadline) == 0)
+        {
+            ++finished;
+        }
+        else if (errno == ETIMEDOUT)
+        {
+            check_workers();
+        }
+    }
+    ++runs;
+}
+
+distributed_timings distributed_fft_workers::slowest_rank() const
+{
+    distributed_timings slowest;
+    const double count = double(runs - runs_at_reset);
+    if (count == 0.0) return slowest;
+    for (unsigned int rank = 0; rank < ranks; ++rank)
+    {
+        const distributed_timings& now = rank_timings()[rank];
+        const distributed_timings& before = timings_at_reset[rank];
+        slowest.compute_ms = std::max(slowest.compute_ms, (now.compute_ms - before.compute_ms) / count);
+        slowest.reorder_ms = std::max(slowest.reorder_ms, (now.reorder_ms - before.reorder_ms) / count);
+        slowest.exchange_ms = std::max(slowest.exchange_ms, (now.exchange_ms - before.exchange_ms) / count);
+    }
+    return slowest;
+}
+
+void distributed_fft_workers::reset_timings()
+{
+    std::copy(rank_timings(), rank_timings() + ranks, timings_at_reset.begin());
+    runs_at_reset = runs;
+}
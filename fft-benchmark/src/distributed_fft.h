@@ -0,0 +1,115 @@
+#pragma once
+
+#include "alltoall_transport.h"
+#include "batched_fft.h"
+#include "fft_simd.h"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <semaphore.h>
+#include <sys/types.h>
+
+using namespace std;
+
+// Time one rank spends in each part of a transform, in milliseconds
+struct distributed_timings
+{
+    double compute_ms = 0.0;  // row FFTs and the twiddle multiply
+    double reorder_ms = 0.0;  // packing blocks for the exchange and unpacking what arrived
+    double exchange_ms = 0.0; // inside the transport, including waiting for slower ranks
+};
+
+// One rank's share of a forward power-of-two DFT spread over P processes, in the
+// transpose (six-step) decomposition: N = n1 * n2 is an n1 x n2 matrix distributed by rows,
+// and each of the three global transposes is an all-to-all through the transport, between
+// n1-point row FFTs and a twiddle multiply, and n2-point row FFTs. Rank r holds
+// x[r N/P, (r+1) N/P) on entry and X over the same range on return, so the slabs stay in
+// natural order. P must be a power of two no larger than n1 = 2^floor(log2(N) / 2).
+class distributed_fft {
+public:
+    distributed_fft(size_t size, unsigned int rank, alltoall_transport& transport, simd_isa isa);
+
+    // slab holds N / P elements
+    void execute(complex<double>* slab);
+
+    size_t slab_size() const { return slab; }
+    // Accumulated over every execute() since construction or the last reset
+    const distributed_timings& timings() const { return spent; }
+    void reset_timings() { spent = {}; }
+
+    static bool is_valid(size_t size, unsigned int ranks);
+    // Elements one rank sends to the others per transform: three exchanges of (P - 1) blocks
+    static size_t exchanged_elements(size_t size, unsigned int ranks);
+
+private:
+    // Global transpose of a rows x cols matrix distributed by rows into the cols x rows one
+    void transpose(complex<double>* slab, size_t rows, size_t cols);
+
+    size_t n;
+    size_t n1;
+    size_t n2;
+    unsigned int rank;
+    unsigned int ranks;
+    size_t slab;
+    alltoall_transport& transport;
+    batched_fft column_engine; // length n1
+    batched_fft row_engine;    // length n2
+    vector<complex<double>> twiddles; // W_N^(n2 k1) for this rank's rows of the n2 x n1 matrix
+    vector<complex<double>> incoming;
+    distributed_timings spent;
+};
+
+// P forked worker processes, rank i in worker i, each running a distributed_fft over its
+// slab of a shared input array and writing its slab of a shared output array. The parent
+// starts a transform with run() and returns once every rank is done; the workers copy their
+// slab in and out around the transform. Workers stop and are reaped by the destructor.
+// The workers form their own process group and die with the parent. If one of them exits,
+// the parent notices while it waits, kills the whole group, as an MPI abort would, and
+// throws from run().
+class distributed_fft_workers {
+public:
+    distributed_fft_workers(size_t size, unsigned int ranks, transport_kind kind, simd_isa isa);
+    ~distributed_fft_workers();
+
+    distributed_fft_workers(const distributed_fft_workers&) = delete;
+    distributed_fft_workers& operator=(const distributed_fft_workers&) = delete;
+
+    span<complex<double>> input() { return {data, n}; }
+    span<const complex<double>> output() const { return {data + n, n}; }
+
+    // Throws runtime_error when a worker has died; the other workers are killed and reaped
+    void run();
+
+    // Mean time per transform since the last reset, per part, of the slowest rank in that part
+    distributed_timings slowest_rank() const;
+    void reset_timings();
+
+private:
+    struct control;
+
+    void worker_main(unsigned int rank, simd_isa isa);
+    // Each rank's accumulated timings and start semaphore, in the shared control block
+    distributed_timings* rank_timings() const;
+    sem_t* start_semaphores() const;
+    // Reaps workers that have exited; if any has, kills the group and throws
+    void check_workers();
+    // SIGKILL to the group, then reaps every worker left
+    void kill_workers();
+
+    size_t n;
+    unsigned int ranks;
+    unique_ptr<alltoall_transport> transport;
+    control* shared = nullptr;
+    size_t control_bytes = 0;
+    complex<double>* data = nullptr; // input, then output, shared with the workers
+    vector<pid_t> workers; // by rank, 0 once reaped
+    pid_t group = 0;
+    uint64_t runs = 0;
+    uint64_t runs_at_reset = 0;
+    vector<distributed_timings> timings_at_reset;
+};
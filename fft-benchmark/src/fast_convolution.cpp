@@ -0,0 +1,190 @@
+#include "fast_convolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // Below this the real FFT pair costs more than it saves, whatever the filter
+    constexpr size_t MIN_FFT_SIZE = 64;
+    // Larger blocks only add latency and memory once the cost per output has flattened
+    constexpr size_t MAX_FFT_SIZE_FACTOR = 64;
+}
+
+fast_convolver::fast_convolver(span<const double> filter, convolution_method method, convolution_kind kind,
+                               size_t fft_size)
+    : m(filter.size()), n(fft_size), block_method(method)
+{
+    if (m == 0)
+    {
+        throw invalid_argument("fast_convolver: the filter is empty");
+    }
+    if (n == 0)
+    {
+        n = choose_fft_size(m);
+    }
+    if ((n & (n - 1)) != 0 || n < 2 * m)
+    {
+        throw invalid_argument("fast_convolver: fft_size must be a power of two >= 2 * filter length");
+    }
+    transform = real_fft::get(n);
+
+    // 1. Correlation is convolution with the time-reversed filter
+    time_block.assign(n, 0.0);
+    if (kind == convolution_kind::correlation)
+    {
+        reverse_copy(filter.begin(), filter.end(), time_block.begin());
+    }
+    else
+    {
+        copy(filter.begin(), filter.end(), time_block.begin());
+    }
+
+    // 2. The cached spectrum carries the 1/N of the inverse transform
+    filter_spectrum.resize(transform->spectrum_size());
+    transform->forward(time_block, filter_spectrum);
+    for (complex<double>& value : filter_spectrum)
+    {
+        value /= double(n);
+    }
+
+    spectrum.resize(transform->spectrum_size());
+    pending.reserve(block_size());
+    reset();
+}
+
+void fast_convolver::reset()
+{
+    pending.clear();
+    overlap.assign(m - 1, 0.0);
+}
+
+void fast_convolver::process(span<const double> input, vector<double>& output)
+{
+    const size_t L = block_size();
+    while (!input.empty())
+    {
+        const size_t take = std::min(L - pending.size(), input.size());
+        pending.insert(pending.end(), input.begin(), input.begin() + take);
+        input = input.subspan(take);
+        if (pending.size() == L)
+        {
+            run_block(L, output);
+        }
+    }
+}
+
+void fast_convolver::flush(vector<double>& output)
+{
+    if (!pending.empty())
+    {
+        run_block(pending.size(), output);
+    }
+    if (block_method == convolution_method::overlap_add)
+    {
+        // The tail is already the convolution of the last samples with the filter
+        output.insert(output.end(), overlap.begin(), overlap.end());
+    }
+    else if (m > 1)
+    {
+        // M - 1 zeros push the last inputs through the filter; L >= M - 1 since N >= 2M
+        pending.assign(m - 1, 0.0);
+        run_block(m - 1, output);
+    }
+    reset();
+}
+
+void fast_convolver::run_block(size_t count, vector<double>& output)
+{
+    const size_t history = m - 1;
+
+    // 1. Time-domain block
+    if (block_method == convolution_method::overlap_save)
+    {
+        // [last M - 1 inputs | count new inputs | zeros]; the next history is the last M - 1 of the two
+        copy(overlap.begin(), overlap.end(), time_block.begin());
+        copy(pending.begin(), pending.begin() + count, time_block.begin() + history);
+        fill(time_block.begin() + history + count, time_block.end(), 0.0);
+        copy(time_block.begin() + count, time_block.begin() + count + history, overlap.begin());
+    }
+    else
+    {
+        copy(pending.begin(), pending.begin() + count, time_block.begin());
+        fill(time_block.begin() + count, time_block.end(), 0.0);
+    }
+    pending.clear();
+
+    // 2. Circular convolution of length N
+    transform->forward(time_block, spectrum);
+    for (size_t k = 0; k < spectrum.size(); ++k)
+    {
+        spectrum[k] *= filter_spectrum[k];
+    }
+    transform->inverse(spectrum, time_block);
+
+    // 3. Outputs of this block
+    if (block_method == convolution_method::overlap_save)
+    {
+        // The first M - 1 outputs wrapped around and are discarded
+        output.insert(output.end(), time_block.begin() + history, time_block.begin() + history + count);
+    }
+    else
+    {
+        // The block's linear convolution is count + M - 1 long; the previous tail overlaps its start
+        for (size_t i = 0; i < history; ++i)
+        {
+            time_block[i] += overlap[i];
+        }
+        output.insert(output.end(), time_block.begin(), time_block.begin() + count);
+        copy(time_block.begin() + count, time_block.begin() + count + history, overlap.begin());
+    }
+}
+
+size_t fast_convolver::choose_fft_size(size_t filter_length)
+{
+    size_t first = MIN_FFT_SIZE;
+    while (first < 2 * filter_length) first <<= 1;
+
+    size_t best = first;
+    double best_cost = INFINITY;
+    for (size_t candidate = first; candidate <= first * MAX_FFT_SIZE_FACTOR; candidate <<= 1)
+    {
+        const double cost = double(candidate) * log2(double(candidate)) / double(candidate - filter_length + 1);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+void fast_convolver::direct(span<const double> input, span<const double> filter, convolution_kind kind,
+                            vector<double>& output)
+{
+    const size_t M = filter.size();
+    vector<double> taps(filter.begin(), filter.end());
+    if (kind == convolution_kind::correlation)
+    {
+        reverse(taps.begin(), taps.end());
+    }
+
+    // Scatter form: every input sample adds a scaled copy of the taps, so the inner loop is
+    // contiguous in both the output and the taps and vectorises
+    output.assign(input.size() + M - 1, 0.0);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        const double x = input[i];
+        double* y = output.data() + i;
+        for (size_t k = 0; k < M; ++k)
+        {
+            y[k] += x * taps[k];
+        }
+    }
+}
+
+const char* fast_convolver::method_name(convolution_method method)
+{
+    return method == convolution_method::overlap_add ? "overlap-add" : "overlap-save";
+}
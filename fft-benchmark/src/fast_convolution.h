@@ -0,0 +1,70 @@
+#pragma once
+
+#include "real_fft.h"
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+enum class convolution_method
+{
+    overlap_add,  // zero-padded blocks, each block's tail added into the next
+    overlap_save  // blocks overlap by M - 1 input samples, the wrapped-around outputs are dropped
+};
+
+enum class convolution_kind
+{
+    convolution, // y[n] = sum_k h[k] x[n - k]
+    correlation  // y[n] = sum_k h[k] x[n - (M - 1) + k]: the full cross-correlation, lag -(M - 1) first
+};
+
+// FIR filtering of an unbounded real stream by FFT. The filter spectrum is computed once
+// (pre-scaled by 1/N, so the unnormalized inverse needs no extra pass); every block of
+// L = N - M + 1 new samples then costs one real FFT, one spectrum multiply and one inverse
+// real FFT of length N. Input may arrive in chunks of any length; outputs are emitted as
+// soon as their block is complete, and flush() ends the stream with the last partial block
+// and the M - 1 tail samples, so a whole stream yields input length + M - 1 outputs.
+class fast_convolver {
+public:
+    // fft_size 0 picks the cheapest power of two per output sample (at least 2M)
+    fast_convolver(span<const double> filter, convolution_method method = convolution_method::overlap_save,
+                   convolution_kind kind = convolution_kind::convolution, size_t fft_size = 0);
+
+    // Consumes the input and appends every completed output sample
+    void process(span<const double> input, vector<double>& output);
+    // Ends the stream: appends the remaining outputs and resets for a new stream
+    void flush(vector<double>& output);
+    void reset();
+
+    size_t filter_length() const { return m; }
+    size_t fft_size() const { return n; }
+    size_t block_size() const { return n - m + 1; }
+    convolution_method method() const { return block_method; }
+
+    // The power of two N >= 2M that minimises N log2 N / (N - M + 1)
+    static size_t choose_fft_size(size_t filter_length);
+
+    // Time-domain reference, O(length * M): the same input length + M - 1 outputs
+    static void direct(span<const double> input, span<const double> filter, convolution_kind kind,
+                       vector<double>& output);
+
+    static const char* method_name(convolution_method method);
+
+private:
+    void run_block(size_t count, vector<double>& output);
+
+    size_t m;
+    size_t n;
+    convolution_method block_method;
+    shared_ptr<const real_fft> transform;
+    vector<complex<double>> filter_spectrum;
+
+    vector<double> pending;    // input of the block being filled
+    vector<double> overlap;    // overlap-save: the last M - 1 inputs; overlap-add: the last block's tail
+    vector<double> time_block; // N-point work buffer
+    vector<complex<double>> spectrum;
+};
@@ -1,5 +1,10 @@
 // fft_kernel.cl
-// OpenCL kernel for one stage of Radix-2 FFT
+// OpenCL kernels for the radix-2 FFT: one launch per stage (fft_kernel), or the small
+// stages fused in local memory (fft_local_stages) followed by one launch per wide stage
+// (fft_global_stage), on input put in bit-reversed order by bit_reverse_permute.
+// The fused kernels share one twiddle table built for the largest size, table_n:
+// twiddles[e] = exp(-2*PI*i*e / table_n) for e < table_n/2, so the twiddle j of stage s
+// of any smaller transform is entry j * (table_n >> s).
 
 // Function to multiply two complex numbers (a + bi) * (c + di) = (ac - bd) + (ad + bc)i
 float2 complex_mul(float2 a, float2 b) {
@@ -46,3 +51,90 @@ __kernel void fft_kernel(
     data[k_group_start + j] = u + t;
     data[k_group_start + j + m_half] = u - t;
 }
+
+// In-place bit-reversal permutation of log_n-bit indices: work-item i swaps with rev(i)
+// when rev(i) > i, so every pair has exactly one owner
+__kernel void bit_reverse_permute(
+    __global float2* data,
+    int log_n
+) {
+    int i = get_global_id(0);
+    if (i >= (1 << log_n)) {
+        return;
+    }
+
+    int r = 0;
+    for (int b = 0; b < log_n; ++b) {
+        r = (r << 1) | ((i >> b) & 1);
+    }
+    if (r > i) {
+        float2 value = data[i];
+        data[i] = data[r];
+        data[r] = value;
+    }
+}
+
+// Stages 1..log2(block) of a bit-reversed input in local memory. Work-group g loads the
+// contiguous block [g * block, (g + 1) * block): the butterflies of those stages never
+// reach outside it. Each work-item takes butterflies lid, lid + L, ... of every stage.
+__kernel void fft_local_stages(
+    __global float2* data,
+    __global const float2* twiddles,
+    int table_n,
+    int log_block,             // stages done here; the block holds 1 << log_block points
+    __local float2* block
+) {
+    int lid = get_local_id(0);
+    int local_size = get_local_size(0);
+    int block_size = 1 << log_block;
+    int base = get_group_id(0) * block_size;
+
+    for (int i = lid; i < block_size; i += local_size) {
+        block[i] = data[base + i];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int stage = 1; stage <= log_block; ++stage) {
+        int m_half = 1 << (stage - 1);
+        int twiddle_stride = table_n >> stage;
+        for (int b = lid; b < block_size / 2; b += local_size) {
+            int j = b & (m_half - 1);
+            int k = ((b >> (stage - 1)) << stage) + j;
+            float2 w = twiddles[j * twiddle_stride];
+            float2 u = block[k];
+            float2 t = complex_mul(w, block[k + m_half]);
+            block[k] = u + t;
+            block[k + m_half] = u - t;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    for (int i = lid; i < block_size; i += local_size) {
+        data[base + i] = block[i];
+    }
+}
+
+// One stage too wide for a work-group's block, as fft_kernel but with the table twiddles
+__kernel void fft_global_stage(
+    __global float2* data,
+    __global const float2* twiddles,
+    int table_n,
+    int N,
+    int stage
+) {
+    int gid = get_global_id(0);
+    if (gid >= N / 2) {
+        return;
+    }
+
+    int m_half = 1 << (stage - 1);
+    int j = gid & (m_half - 1);
+    int k = ((gid >> (stage - 1)) << stage) + j;
+
+    float2 w = twiddles[j * (table_n >> stage)];
+    float2 u = data[k];
+    float2 t = complex_mul(w, data[k + m_half]);
+
+    data[k] = u + t;
+    data[k + m_half] = u - t;
+}
@@ -0,0 +1,85 @@
+#include "fft_plan.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace
+{
+    template <typename T>
+    struct plan_cache
+    {
+        mutex cache_mutex;
+        map<pair<size_t, fft_direction>, shared_ptr<const basic_fft_plan<T>>> plans;
+    };
+
+    template <typename T>
+    plan_cache<T>& cache_for()
+    {
+        static plan_cache<T> cache;
+        return cache;
+    }
+}
+
+template <typename T>
+basic_fft_plan<T>::basic_fft_plan(size_t size, fft_direction direction)
+    : n(size), log_n(0), dir(direction)
+{
+    if (n == 0 || (n & (n - 1)) != 0)
+    {
+        throw invalid_argument("fft_plan: size " + to_string(n) + " is not a power of two");
+    }
+    while ((size_t(1) << log_n) < n) ++log_n;
+
+    // Every twiddle is evaluated directly from its angle instead of by the w *= wm
+    // recurrence, so the error does not grow with the stage length.
+    const long double pi = 3.141592653589793238462643383279502884L;
+    const long double sign = (dir == fft_direction::forward) ? -1.0L : 1.0L;
+    twiddle_re.resize(n > 1 ? n - 1 : 0);
+    twiddle_im.resize(n > 1 ? n - 1 : 0);
+    for (size_t half = 1; half < n; half <<= 1)
+    {
+        for (size_t j = 0; j < half; ++j)
+        {
+            const long double angle = sign * pi * (long double)(j) / (long double)(half);
+            twiddle_re[half - 1 + j] = T(cos(angle));
+            twiddle_im[half - 1 + j] = T(sin(angle));
+        }
+    }
+
+    // rev(i) = rev(i / 2) / 2 with the low bit of i moved to the top
+    reversed.resize(n);
+    reversed[0] = 0;
+    for (size_t i = 1; i < n; ++i)
+    {
+        reversed[i] = (reversed[i >> 1] >> 1) | uint32_t((i & 1) << (log_n - 1));
+    }
+}
+
+template <typename T>
+shared_ptr<const basic_fft_plan<T>> basic_fft_plan<T>::get(size_t size, fft_direction direction)
+{
+    plan_cache<T>& cache = cache_for<T>();
+    lock_guard<mutex> lock(cache.cache_mutex);
+    auto& plan = cache.plans[{size, direction}];
+    if (!plan)
+    {
+        plan = make_shared<const basic_fft_plan<T>>(size, direction);
+    }
+    return plan;
+}
+
+template <typename T>
+void basic_fft_plan<T>::clear_cache()
+{
+    plan_cache<T>& cache = cache_for<T>();
+    lock_guard<mutex> lock(cache.cache_mutex);
+    cache.plans.clear();
+}
+
+template class basic_fft_plan<float>;
+template class basic_fft_plan<double>;
+template class basic_fft_plan<long double>;
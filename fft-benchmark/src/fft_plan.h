@@ -0,0 +1,60 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+enum class fft_direction
+{
+    forward,
+    inverse
+};
+
+// Precomputed tables for a power-of-two radix-2 transform of one size and direction.
+// Twiddles are stored stage by stage: the factors of the stage with half-span h
+// (h = 1, 2, 4, ..., N/2) occupy entries [h - 1 .. 2h - 2], so every butterfly loop
+// reads its table sequentially and no twiddle depends on the previous one.
+// Real and imaginary parts are kept in separate arrays so vector kernels can load
+// them directly; scalar kernels read one element from each.
+// T is the scalar type of the transform (float, double or long double); the twiddles
+// are always evaluated in long double and rounded once to T.
+template <typename T>
+class basic_fft_plan {
+public:
+    basic_fft_plan(size_t size, fft_direction direction);
+
+    size_t size() const { return n; }
+    unsigned int log2_size() const { return log_n; }
+    fft_direction direction() const { return dir; }
+
+    // The h twiddles exp(-+2*pi*i*j / 2h), j = 0..h-1, of the stage with half-span h
+    const T* stage_twiddles_re(size_t half) const { return twiddle_re.data() + half - 1; }
+    const T* stage_twiddles_im(size_t half) const { return twiddle_im.data() + half - 1; }
+    complex<T> twiddle(size_t half, size_t j) const
+    {
+        return {twiddle_re[half - 1 + j], twiddle_im[half - 1 + j]};
+    }
+    const vector<uint32_t>& bit_reversal() const { return reversed; }
+
+    // Returns the cached plan for (size, direction), building it on first use
+    static shared_ptr<const basic_fft_plan> get(size_t size, fft_direction direction = fft_direction::forward);
+    static void clear_cache();
+
+private:
+    size_t n;
+    unsigned int log_n;
+    fft_direction dir;
+    vector<T> twiddle_re;
+    vector<T> twiddle_im;
+    vector<uint32_t> reversed;
+};
+
+using fft_plan = basic_fft_plan<double>;
+
+extern template class basic_fft_plan<float>;
+extern template class basic_fft_plan<double>;
+extern template class basic_fft_plan<long double>;
@@ -0,0 +1,211 @@
+#include "fft_simd.h"
+#include "bit_reversal.h"
+#include "fft_simd_kernels.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#ifdef FFT_HAVE_X86_SIMD
+#include <cpuid.h>
+#endif
+
+namespace
+{
+    struct cpu_features
+    {
+        bool sse2 = false;
+        bool avx2 = false;
+        bool avx512 = false;
+    };
+
+    cpu_features query_cpu_features()
+    {
+        cpu_features features;
+#ifdef FFT_HAVE_X86_SIMD
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        {
+            return features;
+        }
+        features.sse2 = (edx & (1u << 26)) != 0;
+        const bool fma = (ecx & (1u << 12)) != 0;
+        const bool osxsave = (ecx & (1u << 27)) != 0;
+        const bool avx = (ecx & (1u << 28)) != 0;
+
+        // The OS must save the YMM (and for AVX-512 the opmask/ZMM) state on context switches
+        unsigned int xcr0_lo = 0, xcr0_hi = 0;
+        if (osxsave)
+        {
+            __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        }
+        const bool ymm_state = (xcr0_lo & 0x06) == 0x06;
+        const bool zmm_state = (xcr0_lo & 0xe6) == 0xe6;
+
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        {
+            features.avx2 = avx && fma && ymm_state && (ebx & (1u << 5)) != 0;
+            features.avx512 = fma && zmm_state && (ebx & (1u << 16)) != 0;
+        }
+#endif
+        return features;
+    }
+
+    const cpu_features& host_features()
+    {
+        static const cpu_features features = query_cpu_features();
+        return features;
+    }
+
+    fft_stage_kernel<double> interleaved_stage_kernel(simd_isa isa)
+    {
+        switch (isa)
+        {
+#ifdef FFT_HAVE_X86_SIMD
+        case simd_isa::sse2: return fft_interleaved_stage_sse2;
+        case simd_isa::avx2: return fft_interleaved_stage_avx2;
+        case simd_isa::avx512: return fft_interleaved_stage_avx512;
+#endif
+        default: return fft_stage_scalar<double>;
+        }
+    }
+
+    // The vector width follows from T at compile time: float kernels use twice the lanes
+    template <typename T>
+    fft_stage_kernel<T> stage_kernel(simd_isa isa)
+    {
+#ifdef FFT_HAVE_X86_SIMD
+        if constexpr (is_same_v<T, float>)
+        {
+            switch (isa)
+            {
+            case simd_isa::sse2: return fft_stage_sse2_f32;
+            case simd_isa::avx2: return fft_stage_avx2_f32;
+            case simd_isa::avx512: return fft_stage_avx512_f32;
+            default: break;
+            }
+        }
+        else
+        {
+            switch (isa)
+            {
+            case simd_isa::sse2: return fft_stage_sse2;
+            case simd_isa::avx2: return fft_stage_avx2;
+            case simd_isa::avx512: return fft_stage_avx512;
+            default: break;
+            }
+        }
+#endif
+        return fft_stage_scalar<T>;
+    }
+}
+
+template <typename T>
+void fft_stage_scalar(T* re, T* im, size_t n, size_t half, const T* w_re, const T* w_im)
+{
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        T* a_re = re + k;
+        T* a_im = im + k;
+        T* b_re = a_re + half;
+        T* b_im = a_im + half;
+        for (size_t j = 0; j < half; ++j)
+        {
+            const T tr = w_re[j] * b_re[j] - w_im[j] * b_im[j];
+            const T ti = w_re[j] * b_im[j] + w_im[j] * b_re[j];
+            const T ur = a_re[j];
+            const T ui = a_im[j];
+            a_re[j] = ur + tr;
+            a_im[j] = ui + ti;
+            b_re[j] = ur - tr;
+            b_im[j] = ui - ti;
+        }
+    }
+}
+
+template void fft_stage_scalar<float>(float*, float*, size_t, size_t, const float*, const float*);
+template void fft_stage_scalar<double>(double*, double*, size_t, size_t, const double*, const double*);
+
+template <typename T>
+void simd_fft::execute(T* re, T* im, const basic_fft_plan<T>& plan, simd_isa isa)
+{
+    const size_t N = plan.size();
+
+    // 1. Bit-reversal permutation of both halves
+    bit_reversal_permutation::permute(re, N);
+    bit_reversal_permutation::permute(im, N);
+
+    // 2. Stages shorter than one vector, fused into a single pass over width-sized blocks
+    const size_t width = std::min<size_t>(lanes<T>(isa), N);
+    for (size_t base = 0; base + width <= N && width > 1; base += width)
+    {
+        for (size_t half = 1; half < width; half <<= 1)
+        {
+            fft_stage_scalar(re + base, im + base, width, half,
+                             plan.stage_twiddles_re(half), plan.stage_twiddles_im(half));
+        }
+    }
+
+    // 3. Full-width vector stages
+    const fft_stage_kernel<T> stage = stage_kernel<T>(isa);
+    for (size_t half = width; half < N; half <<= 1)
+    {
+        stage(re, im, N, half, plan.stage_twiddles_re(half), plan.stage_twiddles_im(half));
+    }
+}
+
+template void simd_fft::execute<float>(float*, float*, const basic_fft_plan<float>&, simd_isa);
+template void simd_fft::execute<double>(double*, double*, const basic_fft_plan<double>&, simd_isa);
+
+void simd_fft::execute_interleaved_stages(double* re, double* im, const fft_plan& plan, simd_isa isa)
+{
+    const size_t N = plan.size();
+    const fft_stage_kernel<double> stage = interleaved_stage_kernel(isa);
+    for (size_t half = 1; half < N; half <<= 1)
+    {
+        stage(re, im, N, half, plan.stage_twiddles_re(half), plan.stage_twiddles_im(half));
+    }
+}
+
+simd_isa simd_fft::detect_isa()
+{
+    if (is_supported(simd_isa::avx512)) return simd_isa::avx512;
+    if (is_supported(simd_isa::avx2)) return simd_isa::avx2;
+    if (is_supported(simd_isa::sse2)) return simd_isa::sse2;
+    return simd_isa::scalar;
+}
+
+bool simd_fft::is_supported(simd_isa isa)
+{
+    switch (isa)
+    {
+    case simd_isa::scalar: return true;
+    case simd_isa::sse2: return host_features().sse2;
+    case simd_isa::avx2: return host_features().avx2;
+    case simd_isa::avx512: return host_features().avx512;
+    }
+    return false;
+}
+
+const char* simd_fft::isa_name(simd_isa isa)
+{
+    switch (isa)
+    {
+    case simd_isa::sse2: return "sse2";
+    case simd_isa::avx2: return "avx2";
+    case simd_isa::avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+bool simd_fft::parse_isa(const string& name, simd_isa& isa)
+{
+    for (simd_isa candidate : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512})
+    {
+        if (name == isa_name(candidate))
+        {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
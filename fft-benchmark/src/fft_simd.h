@@ -0,0 +1,91 @@
+#pragma once
+
+#include "fft_plan.h"
+
+#include <complex>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum class simd_isa
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+// Split (SoA) complex buffer: all real parts, then all imaginary parts
+template <typename T>
+struct basic_split_complex_buffer
+{
+    vector<T> re;
+    vector<T> im;
+
+    basic_split_complex_buffer() = default;
+    explicit basic_split_complex_buffer(size_t size) : re(size), im(size) {}
+
+    size_t size() const { return re.size(); }
+
+    static basic_split_complex_buffer from_interleaved(span<const complex<T>> data)
+    {
+        basic_split_complex_buffer buffer(data.size());
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            buffer.re[i] = data[i].real();
+            buffer.im[i] = data[i].imag();
+        }
+        return buffer;
+    }
+
+    void to_interleaved(span<complex<T>> data) const
+    {
+        for (size_t i = 0; i < data.size() && i < re.size(); ++i)
+        {
+            data[i] = {re[i], im[i]};
+        }
+    }
+};
+
+using split_complex_buffer = basic_split_complex_buffer<double>;
+
+// Radix-2 FFT on split buffers with explicit SSE2 / AVX2 / AVX-512 butterfly stages.
+// The ISA is chosen at run time from CPUID, so a single binary runs the widest kernel
+// the host supports; stages shorter than one vector run through a fused scalar pass.
+// Both float and double are supported; a float vector holds twice as many lanes.
+class simd_fft {
+public:
+    template <typename T>
+    static void execute(T* re, T* im, const basic_fft_plan<T>& plan, simd_isa isa);
+    template <typename T>
+    static void execute(basic_split_complex_buffer<T>& data, const basic_fft_plan<T>& plan, simd_isa isa)
+    {
+        execute(data.re.data(), data.im.data(), plan, isa);
+    }
+
+    // Runs every butterfly stage over lanes(isa) transforms interleaved element by element
+    // (element i of transform l at re[i * lanes + l]). The input must already be in
+    // bit-reversed order; the batched engine permutes while gathering the frames.
+    static void execute_interleaved_stages(double* re, double* im, const fft_plan& plan, simd_isa isa);
+
+    // Widest ISA that is both compiled in and supported by the CPU and OS
+    static simd_isa detect_isa();
+    static bool is_supported(simd_isa isa);
+
+    // Elements of type T per vector register of the ISA (1 for scalar)
+    template <typename T = double>
+    static constexpr unsigned int lanes(simd_isa isa)
+    {
+        const unsigned int bytes = isa == simd_isa::avx512 ? 64 : isa == simd_isa::avx2 ? 32 : isa == simd_isa::sse2 ? 16 : 0;
+        return bytes > sizeof(T) ? bytes / unsigned(sizeof(T)) : 1;
+    }
+
+    static const char* isa_name(simd_isa isa);
+    // Accepts scalar|sse2|avx2|avx512; returns false for anything else
+    static bool parse_isa(const string& name, simd_isa& isa);
+};
+
+extern template void simd_fft::execute<float>(float*, float*, const basic_fft_plan<float>&, simd_isa);
+extern template void simd_fft::execute<double>(double*, double*, const basic_fft_plan<double>&, simd_isa);
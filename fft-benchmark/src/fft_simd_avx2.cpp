@@ -0,0 +1,92 @@
+#include "fft_simd_kernels.h"
+
+#include <immintrin.h>
+
+void fft_stage_avx2(double* re, double* im, size_t n, size_t half, const double* w_re, const double* w_im)
+{
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        double* a_re = re + k;
+        double* a_im = im + k;
+        double* b_re = a_re + half;
+        double* b_im = a_im + half;
+        for (size_t j = 0; j < half; j += 4)
+        {
+            const __m256d wr = _mm256_loadu_pd(w_re + j);
+            const __m256d wi = _mm256_loadu_pd(w_im + j);
+            const __m256d xr = _mm256_loadu_pd(b_re + j);
+            const __m256d xi = _mm256_loadu_pd(b_im + j);
+
+            // t = w * b
+            const __m256d tr = _mm256_fmsub_pd(wr, xr, _mm256_mul_pd(wi, xi));
+            const __m256d ti = _mm256_fmadd_pd(wr, xi, _mm256_mul_pd(wi, xr));
+
+            const __m256d ur = _mm256_loadu_pd(a_re + j);
+            const __m256d ui = _mm256_loadu_pd(a_im + j);
+            _mm256_storeu_pd(a_re + j, _mm256_add_pd(ur, tr));
+            _mm256_storeu_pd(a_im + j, _mm256_add_pd(ui, ti));
+            _mm256_storeu_pd(b_re + j, _mm256_sub_pd(ur, tr));
+            _mm256_storeu_pd(b_im + j, _mm256_sub_pd(ui, ti));
+        }
+    }
+}
+
+void fft_interleaved_stage_avx2(double* re, double* im, size_t n, size_t half,
+                                const double* w_re, const double* w_im)
+{
+    constexpr size_t lanes = 4;
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        for (size_t j = 0; j < half; ++j)
+        {
+            double* a_re = re + (k + j) * lanes;
+            double* a_im = im + (k + j) * lanes;
+            double* b_re = a_re + half * lanes;
+            double* b_im = a_im + half * lanes;
+
+            const __m256d wr = _mm256_set1_pd(w_re[j]);
+            const __m256d wi = _mm256_set1_pd(w_im[j]);
+            const __m256d xr = _mm256_loadu_pd(b_re);
+            const __m256d xi = _mm256_loadu_pd(b_im);
+
+            const __m256d tr = _mm256_fmsub_pd(wr, xr, _mm256_mul_pd(wi, xi));
+            const __m256d ti = _mm256_fmadd_pd(wr, xi, _mm256_mul_pd(wi, xr));
+
+            const __m256d ur = _mm256_loadu_pd(a_re);
+            const __m256d ui = _mm256_loadu_pd(a_im);
+            _mm256_storeu_pd(a_re, _mm256_add_pd(ur, tr));
+            _mm256_storeu_pd(a_im, _mm256_add_pd(ui, ti));
+            _mm256_storeu_pd(b_re, _mm256_sub_pd(ur, tr));
+            _mm256_storeu_pd(b_im, _mm256_sub_pd(ui, ti));
+        }
+    }
+}
+
+void fft_stage_avx2_f32(float* re, float* im, size_t n, size_t half, const float* w_re, const float* w_im)
+{
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        float* a_re = re + k;
+        float* a_im = im + k;
+        float* b_re = a_re + half;
+        float* b_im = a_im + half;
+        for (size_t j = 0; j < half; j += 8)
+        {
+            const __m256 wr = _mm256_loadu_ps(w_re + j);
+            const __m256 wi = _mm256_loadu_ps(w_im + j);
+            const __m256 xr = _mm256_loadu_ps(b_re + j);
+            const __m256 xi = _mm256_loadu_ps(b_im + j);
+
+            // t = w * b
+            const __m256 tr = _mm256_fmsub_ps(wr, xr, _mm256_mul_ps(wi, xi));
+            const __m256 ti = _mm256_fmadd_ps(wr, xi, _mm256_mul_ps(wi, xr));
+
+            const __m256 ur = _mm256_loadu_ps(a_re + j);
+            const __m256 ui = _mm256_loadu_ps(a_im + j);
+            _mm256_storeu_ps(a_re + j, _mm256_add_ps(ur, tr));
+            _mm256_storeu_ps(a_im + j, _mm256_add_ps(ui, ti));
+            _mm256_storeu_ps(b_re + j, _mm256_sub_ps(ur, tr));
+            _mm256_storeu_ps(b_im + j, _mm256_sub_ps(ui, ti));
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+// One radix-2 butterfly stage with half-span `half` over split arrays of length n.
+// w_re/w_im are the stage's twiddles; half must be a multiple of the vector width.
+// Each ISA lives in its own translation unit, compiled with that ISA's flags only;
+// the _f32 variants are the single-precision kernels with twice the lanes.
+template <typename T>
+using fft_stage_kernel = void (*)(T* re, T* im, size_t n, size_t half, const T* w_re, const T* w_im);
+
+template <typename T>
+void fft_stage_scalar(T* re, T* im, size_t n, size_t half, const T* w_re, const T* w_im);
+
+#ifdef FFT_HAVE_X86_SIMD
+void fft_stage_sse2(double* re, double* im, size_t n, size_t half, const double* w_re, const double* w_im);
+void fft_stage_avx2(double* re, double* im, size_t n, size_t half, const double* w_re, const double* w_im);
+void fft_stage_avx512(double* re, double* im, size_t n, size_t half, const double* w_re, const double* w_im);
+
+void fft_stage_sse2_f32(float* re, float* im, size_t n, size_t half, const float* w_re, const float* w_im);
+void fft_stage_avx2_f32(float* re, float* im, size_t n, size_t half, const float* w_re, const float* w_im);
+void fft_stage_avx512_f32(float* re, float* im, size_t n, size_t half, const float* w_re, const float* w_im);
+#endif
+
+// The same stage over one vector's worth of independent transforms interleaved lane by lane:
+// element i of lane l sits at re[i * lanes + l]. Every butterfly is one full vector and the
+// twiddle is broadcast, so all stages vectorize, including the first ones.
+// With one lane the layout is plain split-complex and fft_stage_scalar applies.
+#ifdef FFT_HAVE_X86_SIMD
+void fft_interleaved_stage_sse2(double* re, double* im, size_t n, size_t half,
+                                const double* w_re, const double* w_im);
+void fft_interleaved_stage_avx2(double* re, double* im, size_t n, size_t half,
+                                const double* w_re, const double* w_im);
+void fft_interleaved_stage_avx512(double* re, double* im, size_t n, size_t half,
+                                  const double* w_re, const double* w_im);
+#endif
@@ -0,0 +1,92 @@
+#include "fft_simd_kernels.h"
+
+#include <emmintrin.h>
+
+void fft_stage_sse2(double* re, double* im, size_t n, size_t half, const double* w_re, const double* w_im)
+{
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        double* a_re = re + k;
+        double* a_im = im + k;
+        double* b_re = a_re + half;
+        double* b_im = a_im + half;
+        for (size_t j = 0; j < half; j += 2)
+        {
+            const __m128d wr = _mm_loadu_pd(w_re + j);
+            const __m128d wi = _mm_loadu_pd(w_im + j);
+            const __m128d xr = _mm_loadu_pd(b_re + j);
+            const __m128d xi = _mm_loadu_pd(b_im + j);
+
+            // t = w * b
+            const __m128d tr = _mm_sub_pd(_mm_mul_pd(wr, xr), _mm_mul_pd(wi, xi));
+            const __m128d ti = _mm_add_pd(_mm_mul_pd(wr, xi), _mm_mul_pd(wi, xr));
+
+            const __m128d ur = _mm_loadu_pd(a_re + j);
+            const __m128d ui = _mm_loadu_pd(a_im + j);
+            _mm_storeu_pd(a_re + j, _mm_add_pd(ur, tr));
+            _mm_storeu_pd(a_im + j, _mm_add_pd(ui, ti));
+            _mm_storeu_pd(b_re + j, _mm_sub_pd(ur, tr));
+            _mm_storeu_pd(b_im + j, _mm_sub_pd(ui, ti));
+        }
+    }
+}
+
+void fft_interleaved_stage_sse2(double* re, double* im, size_t n, size_t half,
+                                const double* w_re, const double* w_im)
+{
+    constexpr size_t lanes = 2;
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        for (size_t j = 0; j < half; ++j)
+        {
+            double* a_re = re + (k + j) * lanes;
+            double* a_im = im + (k + j) * lanes;
+            double* b_re = a_re + half * lanes;
+            double* b_im = a_im + half * lanes;
+
+            const __m128d wr = _mm_set1_pd(w_re[j]);
+            const __m128d wi = _mm_set1_pd(w_im[j]);
+            const __m128d xr = _mm_loadu_pd(b_re);
+            const __m128d xi = _mm_loadu_pd(b_im);
+
+            const __m128d tr = _mm_sub_pd(_mm_mul_pd(wr, xr), _mm_mul_pd(wi, xi));
+            const __m128d ti = _mm_add_pd(_mm_mul_pd(wr, xi), _mm_mul_pd(wi, xr));
+
+            const __m128d ur = _mm_loadu_pd(a_re);
+            const __m128d ui = _mm_loadu_pd(a_im);
+            _mm_storeu_pd(a_re, _mm_add_pd(ur, tr));
+            _mm_storeu_pd(a_im, _mm_add_pd(ui, ti));
+            _mm_storeu_pd(b_re, _mm_sub_pd(ur, tr));
+            _mm_storeu_pd(b_im, _mm_sub_pd(ui, ti));
+        }
+    }
+}
+
+void fft_stage_sse2_f32(float* re, float* im, size_t n, size_t half, const float* w_re, const float* w_im)
+{
+    for (size_t k = 0; k < n; k += 2 * half)
+    {
+        float* a_re = re + k;
+        float* a_im = im + k;
+        float* b_re = a_re + half;
+        float* b_im = a_im + half;
+        for (size_t j = 0; j < half; j += 4)
+        {
+            const __m128 wr = _mm_loadu_ps(w_re + j);
+            const __m128 wi = _mm_loadu_ps(w_im + j);
+            const __m128 xr = _mm_loadu_ps(b_re + j);
+            const __m128 xi = _mm_loadu_ps(b_im + j);
+
+            // t = w * b
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(wr, xr), _mm_mul_ps(wi, xi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(wr, xi), _mm_mul_ps(wi, xr));
+
+            const __m128 ur = _mm_loadu_ps(a_re + j);
+            const __m128 ui = _mm_loadu_ps(a_im + j);
+            _mm_storeu_ps(a_re + j, _mm_add_ps(ur, tr));
+            _mm_storeu_ps(a_im + j, _mm_add_ps(ui, ti));
+            _mm_storeu_ps(b_re + j, _mm_sub_ps(ur, tr));
+            _mm_storeu_ps(b_im + j, _mm_sub_ps(ui, ti));
+        }
+    }
+}
@@ -0,0 +1,278 @@
+#include "fft_tuner.h"
+
+#include "benchmark.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // Below this size the four-step split into two sub-transforms only adds passes
+    constexpr size_t FOUR_STEP_MIN_SIZE = 1024;
+
+    // Blocks tried beside each engine's default, as multiples of it: half and twice the
+    // four-step split, a quarter and four times the bit-reversal tile and depth-first block
+    constexpr size_t FOUR_STEP_SPLIT_STEP = 2;
+    constexpr size_t BLOCK_STEP = 4;
+
+    // One wisdom line split into its fields; false for anything malformed
+    bool parse_line(const string& line, string& model, size_t& size, fft_choice& choice)
+    {
+        vector<string> fields;
+        size_t pos = 0;
+        while (pos <= line.size())
+        {
+            size_t end = line.find('\t', pos);
+            if (end == string::npos) end = line.size();
+            fields.push_back(line.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        // Six fields: a line written before the block field was added
+        if (fields.size() != 6 && fields.size() != 7) return false;
+
+        try
+        {
+            model = fields[0];
+            size = stoull(fields[1]);
+            if (!tuned_fft::parse_engine(fields[2], choice.engine)) return false;
+            choice.threads = unsigned(stoul(fields[3]));
+            if (!simd_fft::parse_isa(fields[4], choice.isa)) return false;
+            choice.block = fields.size() == 7 ? stoull(fields[5]) : 0;
+            choice.time_ms = stod(fields.back());
+        } catch (const std::exception&)
+        {
+            return false;
+        }
+        const bool block_valid = (choice.block & (choice.block - 1)) == 0 &&
+                                 (choice.engine != fft_engine::four_step || choice.block <= size);
+        return size > 0 && (size & (size - 1)) == 0 && choice.threads > 0 && block_valid;
+    }
+}
+
+fft_wisdom::fft_wisdom(string model) : cpu_model(move(model))
+{
+}
+
+bool fft_wisdom::load(const string& path)
+{
+    ifstream file(path);
+    if (!file.is_open()) return false;
+
+    string line;
+    while (getline(file, line))
+    {
+        string model;
+        size_t size = 0;
+        fft_choice choice;
+        if (line.empty() || line[0] == '#' || !parse_line(line, model, size, choice)) continue;
+        if (model != cpu_model) continue;
+        if (choice.engine == fft_engine::simd && !simd_fft::is_supported(choice.isa)) continue;
+        entries[size] = choice;
+    }
+    return true;
+}
+
+void fft_wisdom::save(const string& path) const
+{
+    // Other models' lines survive a re-tune of this one
+    vector<string> kept;
+    {
+        ifstream existing(path);
+        string line;
+        while (getline(existing, line))
+        {
+            string model;
+            size_t size = 0;
+            fft_choice choice;
+            if (parse_line(line, model, size, choice) && model != cpu_model) kept.push_back(line);
+        }
+    }
+
+    ofstream file(path);
+    if (!file.is_open())
+    {
+        throw runtime_error("fft_wisdom: cannot write " + path);
+    }
+    file << "# model\tsize\tengine\tthreads\tisa\tblock\ttime_ms" << endl;
+    for (const string& line : kept)
+    {
+        file << line << endl;
+    }
+    for (const auto& [size, choice] : entries)
+    {
+        file << cpu_model << "\t" << size << "\t" << tuned_fft::engine_name(choice.engine) << "\t" << choice.threads
+            << "\t" << simd_fft::isa_name(choice.isa) << "\t" << choice.block << "\t" << choice.time_ms << endl;
+    }
+}
+
+const fft_choice* fft_wisdom::find(size_t n) const
+{
+    auto it = entries.find(n);
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+tuned_fft::tuned_fft(size_t size, const fft_choice& choice) : n(size), selected(choice), plan(fft_plan::get(size))
+{
+    // A default block becomes the one actually used, so choice() reports it
+    switch (choice.engine)
+    {
+    case fft_engine::four_step:
+        blocked = make_unique<four_step_fft>(size, fft_direction::forward, choice.block);
+        selected.block = blocked->rows();
+        break;
+    case fft_engine::simd:
+        split = split_complex_buffer(size);
+        break;
+    case fft_engine::depth_first:
+        if (selected.block == 0) selected.block = benchmark::DEPTH_FIRST_BLOCK;
+        break;
+    case fft_engine::radix2:
+    case fft_engine::radix4:
+        if (selected.block == 0) selected.block = bit_reversal_permutation::TILE_BYTES;
+        break;
+    default:
+        break;
+    }
+}
+
+void tuned_fft::execute(span<complex<double>> data, thread_pool* pool)
+{
+    if (data.size() != n)
+    {
+        throw invalid_argument("tuned_fft: data size does not match the choice");
+    }
+    const bool threaded = selected.threads > 1 && pool != nullptr;
+
+    switch (selected.engine)
+    {
+    case fft_engine::radix4:
+        if (threaded) benchmark::fft_radix4_multithreaded(data, *plan, *pool, nullptr, selected.block);
+        else benchmark::fft_radix4(data, *plan, nullptr, selected.block);
+        break;
+    case fft_engine::split_radix:
+        benchmark::fft_split_radix(data, *plan);
+        break;
+    case fft_engine::simd:
+        for (size_t i = 0; i < n; ++i)
+        {
+            split.re[i] = data[i].real();
+            split.im[i] = data[i].imag();
+        }
+        simd_fft::execute(split, *plan, selected.isa);
+        split.to_interleaved(data);
+        break;
+    case fft_engine::four_step:
+        blocked->execute(data);
+        break;
+    case fft_engine::depth_first:
+        if (pool != nullptr) benchmark::fft_depth_first(data, *plan, *pool, nullptr, selected.block);
+        else benchmark::fft_iterative(data, *plan);
+        break;
+    default:
+        if (threaded) benchmark::fft_iterative_multithreaded(data, *plan, *pool, nullptr, selected.block);
+        else benchmark::fft_iterative(data, *plan, nullptr, selected.block);
+        break;
+    }
+}
+
+vector<fft_choice> tuned_fft::candidates(size_t n, unsigned int max_threads, simd_isa isa)
+{
+    vector<fft_choice> result;
+    auto add = [&](fft_engine engine, unsigned int threads, simd_isa kernel_isa = simd_isa::scalar, size_t block = 0)
+    {
+        fft_choice choice;
+        choice.engine = engine;
+        choice.threads = threads;
+        choice.isa = kernel_isa;
+        choice.block = block;
+        result.push_back(choice);
+    };
+    // Default first, then the smaller and the larger block; blocks above `limit` act as
+    // `limit`, so only the first of those is kept
+    auto add_blocks = [&](fft_engine engine, unsigned int threads, size_t block, size_t step, size_t limit)
+    {
+        bool limit_added = false;
+        for (size_t value : {block, block / step, block * step})
+        {
+            if (value >= limit)
+            {
+                if (limit_added) continue;
+                limit_added = true;
+            }
+            add(engine, threads, simd_isa::scalar, value);
+        }
+    };
+
+    // The tile only matters once the permutation runs blocked
+    const bool tiled = bit_reversal_permutation::is_blocked<complex<double>>(n);
+    auto add_radix = [&](fft_engine engine, unsigned int threads)
+    {
+        if (tiled) add_blocks(engine, threads, bit_reversal_permutation::TILE_BYTES, BLOCK_STEP, SIZE_MAX);
+        else add(engine, threads);
+    };
+
+    add_radix(fft_engine::radix2, 1);
+    add_radix(fft_engine::radix4, 1);
+    add(fft_engine::split_radix, 1);
+    add(fft_engine::simd, 1, isa);
+    if (n >= FOUR_STEP_MIN_SIZE)
+    {
+        add_blocks(fft_engine::four_step, 1, four_step_fft::default_rows(n), FOUR_STEP_SPLIT_STEP, n);
+    }
+
+    for (unsigned int threads = 2; threads < 2 * max_threads; threads *= 2)
+    {
+        const unsigned int count = std::min(threads, max_threads);
+        add_radix(fft_engine::radix2, count);
+        add_radix(fft_engine::radix4, count);
+        add_blocks(fft_engine::depth_first, count, benchmark::DEPTH_FIRST_BLOCK, BLOCK_STEP, n);
+        if (count == max_threads) break;
+    }
+    return result;
+}
+
+const char* tuned_fft::engine_name(fft_engine engine)
+{
+    switch (engine)
+    {
+    case fft_engine::radix4: return "radix4";
+    case fft_engine::split_radix: return "split";
+    case fft_engine::simd: return "simd";
+    case fft_engine::four_step: return "four-step";
+    case fft_engine::depth_first: return "depth-first";
+    default: return "radix2";
+    }
+}
+
+bool tuned_fft::parse_engine(const string& name, fft_engine& engine)
+{
+    for (fft_engine candidate : {fft_engine::radix2, fft_engine::radix4, fft_engine::split_radix, fft_engine::simd,
+                                 fft_engine::four_step, fft_engine::depth_first})
+    {
+        if (name == engine_name(candidate))
+        {
+            engine = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+string tuned_fft::describe(const fft_choice& choice)
+{
+    ostringstream text;
+    text << engine_name(choice.engine);
+    if (choice.engine == fft_engine::simd) text << "/" << simd_fft::isa_name(choice.isa);
+    if (choice.threads > 1) text << " x" << choice.threads;
+    if (choice.block != 0)
+    {
+        if (choice.engine == fft_engine::four_step) text << " rows " << choice.block;
+        else if (choice.engine == fft_engine::depth_first) text << " block " << choice.block;
+        else text << " tile " << choice.block << " B";
+    }
+    return text.str();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "fft_plan.h"
+#include "fft_simd.h"
+#include "four_step_fft.h"
+
+#include <complex>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class thread_pool;
+
+// Forward double transforms the tuner chooses between
+enum class fft_engine
+{
+    radix2,
+    radix4,
+    split_radix, // single-threaded only
+    simd,        // split-buffer vector kernels, single-threaded; the timing includes the layout conversion
+    four_step,   // cache-blocked six-step, single-threaded
+    depth_first  // cache-sized blocks as pool tasks, multithreaded only
+};
+
+// One way to run a transform of some size, and its median time when it was measured
+struct fft_choice
+{
+    fft_engine engine = fft_engine::radix2;
+    unsigned int threads = 1; // above 1 only for radix2, radix4 and depth_first, on a pool of that size
+    simd_isa isa = simd_isa::scalar; // used by fft_engine::simd only
+    // The engine's blocking parameter, 0 for its default: the bit-reversal tile in bytes for
+    // radix2 and radix4, the largest block in points for depth_first, the split n1 for four_step
+    size_t block = 0;
+    double time_ms = 0.0;
+};
+
+// The fastest choice per size for one CPU model, as found by a tuning run. The file holds
+// one tab-separated line per (CPU model, size), so one file can serve several machines:
+//   model <TAB> size <TAB> engine <TAB> threads <TAB> isa <TAB> block <TAB> time_ms
+// Lines without the block field, from before it existed, load with the default block.
+class fft_wisdom {
+public:
+    explicit fft_wisdom(string cpu_model);
+
+    // Reads this model's lines; false when the file cannot be opened. Malformed lines and
+    // ISAs the CPU cannot run are skipped.
+    bool load(const string& path);
+    // Rewrites the file with this model's entries, keeping the other models' lines.
+    // Throws runtime_error when it cannot be written.
+    void save(const string& path) const;
+
+    // The entry for exactly n, or nullptr
+    const fft_choice* find(size_t n) const;
+    void record(size_t n, const fft_choice& choice) { entries[n] = choice; }
+
+    const string& model() const { return cpu_model; }
+    size_t size() const { return entries.size(); }
+
+private:
+    string cpu_model;
+    map<size_t, fft_choice> entries;
+};
+
+// A choice made ready for one size: plan, four-step engine and split buffer are set up at
+// construction, so execute() only transforms. Multithreaded choices need a pool with
+// choice.threads participants.
+class tuned_fft {
+public:
+    tuned_fft(size_t size, const fft_choice& choice);
+
+    void execute(span<complex<double>> data, thread_pool* pool = nullptr);
+
+    const fft_choice& choice() const { return selected; }
+
+    // Every choice worth measuring at size n: each single-threaded engine, then radix-2,
+    // radix-4 and depth-first on 2, 4, 8, ... threads and on max_threads itself. Each engine
+    // with a block is tried at its default and at a smaller and a larger one: radix-2 and
+    // radix-4 only where the permutation is blocked, four-step at n1 / 2, n1 and 2 n1.
+    static vector<fft_choice> candidates(size_t n, unsigned int max_threads, simd_isa isa);
+
+    static const char* engine_name(fft_engine engine);
+    // Accepts radix2|radix4|split|simd|four-step|depth-first; returns false for anything else
+    static bool parse_engine(const string& name, fft_engine& engine);
+    // "radix4 x8", "simd/avx2", "four-step", "depth-first x8 block 4096", "radix2 tile 4096 B"
+    static string describe(const fft_choice& choice);
+
+private:
+    size_t n;
+    fft_choice selected;
+    shared_ptr<const fft_plan> plan;
+    unique_ptr<four_step_fft> blocked;
+    split_complex_buffer split;
+};
@@ -0,0 +1,152 @@
+#include "fft_validation.h"
+
+#include "benchmark.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace
+{
+    // Terms per double partial sum in sampled_bin_error
+    constexpr size_t SUM_BLOCK = 256;
+}
+
+vector<complex<double>> fft_validation::naive_dft(span<const complex<double>> input, fft_direction direction)
+{
+    const size_t n = input.size();
+    const long double pi = 3.141592653589793238462643383279502884L;
+    const long double sign = (direction == fft_direction::forward) ? -1.0L : 1.0L;
+
+    // W^e for every e mod N, so the O(N^2) loop is table lookups
+    vector<complex<long double>> roots(n);
+    for (size_t e = 0; e < n; ++e)
+    {
+        const long double angle = sign * 2.0L * pi * (long double)(e) / (long double)(n);
+        roots[e] = {cos(angle), sin(angle)};
+    }
+
+    vector<complex<double>> output(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        complex<long double> sum = 0.0L;
+        size_t e = 0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            sum += complex<long double>(input[j].real(), input[j].imag()) * roots[e];
+            e += k;
+            if (e >= n) e -= n;
+        }
+        output[k] = {double(sum.real()), double(sum.imag())};
+    }
+    return output;
+}
+
+double fft_validation::check_forward(span<const complex<double>> input, span<const complex<double>> result)
+{
+    // Inverse round trip through the radix-4 kernel; the sampled bins make the check
+    // independent of it
+    const size_t n = input.size();
+    return check_forward(input, result, [n](span<complex<double>> data)
+    {
+        benchmark::fft_inverse(data, *fft_plan::get(n), false);
+    });
+}
+
+double fft_validation::check_forward(span<const complex<double>> input, span<const complex<double>> result,
+                                     const function<void(span<complex<double>>)>& inverse)
+{
+    const size_t n = input.size();
+    if (n <= DFT_MAX_SIZE)
+    {
+        return relative_error<double>(result, naive_dft(input));
+    }
+
+    vector<complex<double>> round_trip(result.begin(), result.end());
+    inverse(round_trip);
+    const double scale = 1.0 / double(n);
+    for (complex<double>& value : round_trip)
+    {
+        value *= scale;
+    }
+    return std::max(relative_error<double>(round_trip, input), sampled_bin_error(input, result));
+}
+
+double fft_validation::sampled_bin_error(span<const complex<double>> input, span<const complex<double>> result)
+{
+    const size_t n = input.size();
+    const long double pi = 3.141592653589793238462643383279502884L;
+
+    // W^e = W^(hi * block) * W^lo, from two tables of about sqrt(N) roots each instead of N;
+    // the roots are exact to double rounding and each product adds about one ulp
+    unsigned int shift = 0;
+    while ((size_t(1) << (2 * shift)) < n) ++shift;
+    const size_t block = size_t(1) << shift;
+    vector<complex<double>> low(block);
+    vector<complex<double>> high((n >> shift) + 1);
+    for (size_t e = 0; e < low.size(); ++e)
+    {
+        const long double angle = -2.0L * pi * (long double)(e) / (long double)(n);
+        low[e] = {double(cos(angle)), double(sin(angle))};
+    }
+    for (size_t e = 0; e < high.size(); ++e)
+    {
+        const long double angle = -2.0L * pi * (long double)(e << shift) / (long double)(n);
+        high[e] = {double(cos(angle)), double(sin(angle))};
+    }
+
+    long double energy = 0.0L;
+    for (const complex<double>& value : input)
+    {
+        energy += (long double)(norm(value));
+    }
+
+    // Seeded with N, so a failure reproduces
+    mt19937_64 gen(n);
+    uniform_int_distribution<size_t> pick(0, n - 1);
+    long double max_diff = 0.0L;
+    for (size_t sample = 0; sample < SAMPLED_BINS; ++sample)
+    {
+        const size_t k = pick(gen);
+        // Partial sums of SUM_BLOCK terms in double, added up in long double, so the
+        // summation error does not grow with N
+        long double sum_re = 0.0L;
+        long double sum_im = 0.0L;
+        size_t e = 0;
+        for (size_t start = 0; start < n; start += SUM_BLOCK)
+        {
+            double part_re = 0.0;
+            double part_im = 0.0;
+            for (size_t j = start; j < std::min(n, start + SUM_BLOCK); ++j)
+            {
+                const complex<double> a = high[e >> shift];
+                const complex<double> b = low[e & (block - 1)];
+                const double w_re = a.real() * b.real() - a.imag() * b.imag();
+                const double w_im = a.real() * b.imag() + a.imag() * b.real();
+                part_re += input[j].real() * w_re - input[j].imag() * w_im;
+                part_im += input[j].real() * w_im + input[j].imag() * w_re;
+                e += k;
+                if (e >= n) e -= n;
+            }
+            sum_re += part_re;
+            sum_im += part_im;
+        }
+        max_diff = std::max(max_diff, hypot((long double)(result[k].real()) - sum_re,
+                                            (long double)(result[k].imag()) - sum_im));
+    }
+    const long double rms = sqrt(energy);
+    return rms > 0.0L ? double(max_diff / rms) : double(max_diff);
+}
+
+double fft_validation::error_bound(size_t n)
+{
+    return error_bound(n, numeric_limits<double>::epsilon());
+}
+
+double fft_validation::error_bound(size_t n, double epsilon)
+{
+    unsigned int log_n = 1;
+    while ((size_t(1) << log_n) < n) ++log_n;
+    // The round trip runs two transforms, so the bound covers both
+    return 2.0 * 16.0 * std::max(epsilon, numeric_limits<double>::epsilon()) * double(log_n);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "fft_plan.h"
+
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+// Correctness checks for the benchmarked kernels. Up to DFT_MAX_SIZE points a forward
+// result is compared with a naive O(N^2) DFT. Above that, SAMPLED_BINS bins picked at
+// random are computed directly in O(N) each, which shares no code with any kernel, and the
+// whole result is also transformed back and compared with the input (inverse round trip)
+// to cover the bins the sample misses.
+class fft_validation {
+public:
+    static constexpr size_t DFT_MAX_SIZE = 4096;
+    static constexpr size_t SAMPLED_BINS = 8;
+
+    static vector<complex<double>> naive_dft(span<const complex<double>> input,
+                                             fft_direction direction = fft_direction::forward);
+
+    // Relative error of `result`, the forward transform of `input`
+    static double check_forward(span<const complex<double>> input, span<const complex<double>> result);
+    // The same with the round trip through `inverse`, an unnormalized inverse transform of
+    // that length, for lengths the radix-4 kernel does not take
+    static double check_forward(span<const complex<double>> input, span<const complex<double>> result,
+                                const function<void(span<complex<double>>)>& inverse);
+    // Largest error of SAMPLED_BINS randomly chosen bins of `result` against a direct DFT of
+    // each, relative to the RMS bin magnitude (by Parseval, the input's L2 norm)
+    static double sampled_bin_error(span<const complex<double>> input, span<const complex<double>> result);
+
+    // Largest acceptable relative error for a double transform of n points: a few ulps per stage
+    static double error_bound(size_t n);
+    // The same for kernels with unit roundoff epsilon (float, long double); never below the
+    // double bound, since the check itself runs in double
+    static double error_bound(size_t n, double epsilon);
+
+    // max |x - x_ref| / max |x_ref|, evaluated in long double
+    template <typename T>
+    static double relative_error(span<const complex<T>> result, span<const complex<double>> reference)
+    {
+        long double max_diff = 0.0L;
+        long double max_ref = 0.0L;
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            const complex<long double> ref(reference[i].real(), reference[i].imag());
+            const complex<long double> value(result[i].real(), result[i].imag());
+            max_diff = std::max(max_diff, abs(value - ref));
+            max_ref = std::max(max_ref, abs(ref));
+        }
+        return max_ref > 0.0L ? double(max_diff / max_ref) : double(max_diff);
+    }
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "fft_plan.h"
+
+#include <complex>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+// Bailey's FFT for large power-of-two sizes, in its six-step form.
+// N = n1 * n2 is viewed as an n2 x n1 matrix; the transform becomes n1 FFTs of
+// length n2 and n2 FFTs of length n1, each small enough to stay in cache, joined by
+// blocked transposes and a twiddle multiply. Every pass streams over the array once,
+// instead of the log2(N) full sweeps of the radix-2 loop.
+// The split n1 = rows() is a power of two; the default one is the most square.
+class four_step_fft {
+public:
+    // rows = 0 picks default_rows(size); any other power of two up to size sets n1
+    explicit four_step_fft(size_t size, fft_direction direction = fft_direction::forward, size_t rows = 0);
+
+    void execute(span<complex<double>> data);
+
+    size_t size() const { return n; }
+    size_t rows() const { return n1; }
+    size_t cols() const { return n2; }
+
+    // n1 when no split is given: 2^floor(log2(size) / 2)
+    static size_t default_rows(size_t size);
+
+    // Out-of-place transpose of a rows x cols row-major matrix, tile by tile
+    static void transpose(const complex<double>* src, complex<double>* dst, size_t rows, size_t cols);
+
+private:
+    // exp(-+2*pi*i*e / N) from two small tables: e = hi * 2^lo_bits + lo
+    complex<double> twiddle(size_t e) const { return twiddle_hi[e >> lo_bits] * twiddle_lo[e & lo_mask]; }
+
+    size_t n;
+    size_t n1;
+    size_t n2;
+    unsigned int lo_bits;
+    size_t lo_mask;
+    shared_ptr<const fft_plan> row_plan;    // length n2
+    shared_ptr<const fft_plan> column_plan; // length n1
+    vector<complex<double>> twiddle_lo;
+    vector<complex<double>> twiddle_hi;
+    vector<complex<double>> scratch;
+};
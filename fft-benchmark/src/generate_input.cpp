@@ -4,6 +4,9 @@
 #include <vector>
 #include <random>
 #include <iomanip>
+#include <algorithm>
+
+#include "signal_file.h"
 
 // Function to check if a number is a power of two
 bool is_power_of_two(long long n)
@@ -11,11 +14,68 @@ bool is_power_of_two(long long n)
     return (n > 0) && ((n & (n - 1)) == 0);
 }
 
+// Writes the samples after a signal_file header, a block at a time
+template <typename E>
+void write_binary_samples(std::ofstream& out_stream, long long num_samples, bool complex_samples,
+                          std::mt19937& gen, std::uniform_real_distribution<>& dis)
+{
+    const size_t values_per_sample = complex_samples ? 2 : 1;
+    std::vector<E> block;
+    block.reserve(65536 * values_per_sample);
+    for (long long written = 0; written < num_samples;)
+    {
+        const long long count = std::min<long long>(65536, num_samples - written);
+        block.clear();
+        for (long long i = 0; i < count * (long long)values_per_sample; ++i)
+        {
+            block.push_back(E(dis(gen)));
+        }
+        out_stream.write(reinterpret_cast<const char*>(block.data()), std::streamsize(block.size() * sizeof(E)));
+        written += count;
+    }
+}
+
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    if (argc < 3)
     {
-        std::cerr << "Usage: " << argv[0] << " <num_samples> <output_file>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <num_samples> <output_file>"
+            << " [--format text|binary] [--type float|double] [--complex]" << std::endl;
+        return 1;
+    }
+
+    // Text output is one sample per line; binary output is the signal_file format that
+    // fft_benchmark --input-file maps directly
+    bool binary = false;
+    bool complex_samples = false;
+    signal_element_type element_type = signal_element_type::float64;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--format" && (value == "text" || value == "binary"))
+        {
+            binary = value == "binary";
+            ++i;
+        }
+        else if (arg == "--type" && (value == "float" || value == "double"))
+        {
+            element_type = value == "float" ? signal_element_type::float32 : signal_element_type::float64;
+            ++i;
+        }
+        else if (arg == "--complex")
+        {
+            complex_samples = true;
+        }
+        else
+        {
+            std::cerr << "Error: Unknown or incomplete option '" << arg << "'" << std::endl;
+            return 1;
+        }
+    }
+    if (!binary && (complex_samples || element_type != signal_element_type::float64))
+    {
+        std::cerr << "Error: --type and --complex require --format binary" << std::endl;
         return 1;
     }
 
@@ -44,12 +104,13 @@ int main(int argc, char* argv[])
 
     if (!is_power_of_two(num_samples))
     {
-        std::cout << "Warning: " << num_samples <<
-            " is not a power of 2. FFT algorithms are most efficient with input sizes that are powers of 2." <<
+        std::cout << "Note: " << num_samples <<
+            " is not a power of 2. fft_benchmark --input-file only transforms power-of-two prefixes of it" <<
+            " (the largest one in out-of-core mode), so the samples past the largest power of 2 are unused." <<
             std::endl;
     }
 
-    std::ofstream out_stream(output_file);
+    std::ofstream out_stream(output_file, binary ? std::ios::binary : std::ios::out);
     if (!out_stream.is_open())
     {
         std::cerr << "Error: Failed to open output file '" << output_file << "'" << std::endl;
@@ -61,11 +122,33 @@ int main(int argc, char* argv[])
     std::mt19937 gen(rd());
     std::uniform_real_distribution<> dis(0.0, 1.0);
 
-    out_stream << std::fixed << std::setprecision(10);
+    if (binary)
+    {
+        const signal_layout layout = complex_samples ? signal_layout::complex : signal_layout::real;
+        signal_file::write_header(out_stream, signal_file::make_header(num_samples, element_type, layout));
+        if (element_type == signal_element_type::float32)
+        {
+            write_binary_samples<float>(out_stream, num_samples, complex_samples, gen, dis);
+        }
+        else
+        {
+            write_binary_samples<double>(out_stream, num_samples, complex_samples, gen, dis);
+        }
+    }
+    else
+    {
+        out_stream << std::fixed << std::setprecision(10);
+
+        for (long long i = 0; i < num_samples; ++i)
+        {
+            out_stream << dis(gen) << "\n";
+        }
+    }
 
-    for (long long i = 0; i < num_samples; ++i)
+    if (!out_stream)
     {
-        out_stream << dis(gen) << "\n";
+        std::cerr << "Error: Failed to write '" << output_file << "'" << std::endl;
+        return 1;
     }
 
     std::cout << "Successfully generated " << num_samples << " samples in '" << output_file << "'" << std::endl;
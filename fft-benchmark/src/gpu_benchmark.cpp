@@ -4,8 +4,18 @@
 #include <string>
 #include <chrono>
 #include <complex>
+#include <memory>
 #include <random>
+#include <span>
 #include <algorithm> // For std::reverse
+#include <cfloat>
+#include <cstdlib>
+#include <numbers>
+
+#include "bit_reversal.h"
+#include "buffer_arena.h"
+#include "fft_plan.h"
+#include "timing_harness.h"
 
 // OpenCL headers
 #ifdef __APPLE__
@@ -18,6 +28,46 @@
 #define KERNEL_FILE_PATH "fft_kernel.cl" // Fallback for non-CMake builds
 #endif
 
+// Largest block a work-group transforms in local memory: 32 KB of float2, within the
+// local memory of current GPUs and of CPU implementations such as PoCL
+const size_t LOCAL_BLOCK_MAX = 4096;
+// Upper limit on work-items per work-group for the fused kernel
+const size_t LOCAL_WORK_SIZE_MAX = 256;
+// Work-group size of the one-item-per-point and one-item-per-butterfly kernels
+const size_t SIMPLE_WORK_SIZE = 64;
+
+// Acceptable Max_Error of an N-point float transform: a few float ulps per radix-2 stage,
+// the tolerance the CPU kernels are validated with, at float's unit roundoff
+const double ERROR_ULPS_PER_STAGE = 16.0;
+
+// Transforms in flight in the streamed run, one command queue and one device buffer each,
+// so the upload of one, the kernels of another and the download of a third can overlap
+const int STREAM_QUEUES = 3;
+// A streamed run covers STREAM_POINTS points, at least two transforms per queue and at
+// most STREAM_TRANSFORMS_MAX transforms
+const size_t STREAM_POINTS = size_t(1) << 24;
+const size_t STREAM_TRANSFORMS_MAX = 64;
+
+// Kernels and launch limits of the fused path, shared by every queue. The twiddle table is
+// built once for the largest size and read by all smaller ones.
+struct FusedFFT {
+    cl_kernel permute;
+    cl_kernel local;
+    cl_kernel global;
+    cl_mem twiddles;
+    int tableN;
+    size_t blockLimit;
+    size_t localSizeLimit;
+};
+
+// The commands of one transform, each depending on the one before
+struct TransformEvents {
+    cl_event upload = NULL;
+    cl_event permute = NULL;
+    std::vector<cl_event> compute; // fft_local_stages, then one fft_global_stage per wide stage
+    cl_event download = NULL;
+};
+
 // Helper function to check OpenCL errors
 void checkError(cl_int err, const char* name) {
     if (err != CL_SUCCESS) {
@@ -26,6 +76,118 @@ void checkError(cl_int err, const char* name) {
     }
 }
 
+// Kernel execution time of a finished command from its profiling info
+double eventDurationMs(cl_event event) {
+    cl_ulong time_start, time_end;
+    clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &time_start, NULL);
+    clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &time_end, NULL);
+    return (time_end - time_start) / 1000000.0;
+}
+
+// Largest power of two not above n (n >= 1)
+size_t floorPow2(size_t n) {
+    size_t p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+// Sum of the kernel times of several finished commands
+double eventsDurationMs(const std::vector<cl_event>& events) {
+    double total = 0;
+    for (cl_event event : events) {
+        total += eventDurationMs(event);
+    }
+    return total;
+}
+
+void releaseEvents(TransformEvents& events) {
+    clReleaseEvent(events.upload);
+    clReleaseEvent(events.permute);
+    for (cl_event event : events.compute) {
+        clReleaseEvent(event);
+    }
+    clReleaseEvent(events.download);
+}
+
+// Enqueues upload, permutation, fused FFT and download of one N-point transform without
+// blocking. Each command waits on the event of the one before, which an in-order queue
+// implies anyway but keeps the chain valid on an out-of-order queue. Kernel arguments are
+// captured at enqueue time, so the shared kernels can be re-armed for the next transform
+// straight away.
+TransformEvents enqueueTransform(cl_command_queue queue, const FusedFFT& fft, cl_mem d_data,
+                                 const cl_float2* h_in, cl_float2* h_out, int N) {
+    cl_int err;
+    TransformEvents events;
+    int logN = 0;
+    while ((1 << logN) < N) ++logN;
+
+    err = clEnqueueWriteBuffer(queue, d_data, CL_FALSE, 0, sizeof(cl_float2) * N, h_in, 0, NULL, &events.upload);
+    checkError(err, "clEnqueueWriteBuffer");
+
+    size_t permuteGlobalSize[1] = { (size_t)N };
+    size_t permuteLocalSize[1] = { std::min<size_t>(N, SIMPLE_WORK_SIZE) };
+    err = clSetKernelArg(fft.permute, 0, sizeof(cl_mem), &d_data);
+    err |= clSetKernelArg(fft.permute, 1, sizeof(cl_int), &logN);
+    checkError(err, "clSetKernelArg (bit_reverse_permute)");
+    err = clEnqueueNDRangeKernel(queue, fft.permute, 1, NULL, permuteGlobalSize, permuteLocalSize, 1,
+                                 &events.upload, &events.permute);
+    checkError(err, "clEnqueueNDRangeKernel (bit_reverse_permute)");
+
+    const size_t block = std::min<size_t>(N, fft.blockLimit);
+    int logBlock = 0;
+    while ((size_t(1) << logBlock) < block) ++logBlock;
+    size_t fusedLocalSize[1] = { std::min(block / 2, fft.localSizeLimit) };
+    size_t fusedGlobalSize[1] = { (N / block) * fusedLocalSize[0] };
+    err = clSetKernelArg(fft.local, 0, sizeof(cl_mem), &d_data);
+    err |= clSetKernelArg(fft.local, 1, sizeof(cl_mem), &fft.twiddles);
+    err |= clSetKernelArg(fft.local, 2, sizeof(cl_int), &fft.tableN);
+    err |= clSetKernelArg(fft.local, 3, sizeof(cl_int), &logBlock);
+    err |= clSetKernelArg(fft.local, 4, sizeof(cl_float2) * block, NULL);
+    checkError(err, "clSetKernelArg (fft_local_stages)");
+    events.compute.resize(1 + logN - logBlock);
+    err = clEnqueueNDRangeKernel(queue, fft.local, 1, NULL, fusedGlobalSize, fusedLocalSize, 1, &events.permute,
+                                 &events.compute[0]);
+    checkError(err, "clEnqueueNDRangeKernel (fft_local_stages)");
+
+    size_t stageGlobalSize[1] = { (size_t)N / 2 };
+    size_t stageLocalSize[1] = { std::min<size_t>(N / 2, SIMPLE_WORK_SIZE) };
+    err = clSetKernelArg(fft.global, 0, sizeof(cl_mem), &d_data);
+    err |= clSetKernelArg(fft.global, 1, sizeof(cl_mem), &fft.twiddles);
+    err |= clSetKernelArg(fft.global, 2, sizeof(cl_int), &fft.tableN);
+    err |= clSetKernelArg(fft.global, 3, sizeof(cl_int), &N);
+    checkError(err, "clSetKernelArg (fft_global_stage)");
+    for (int stage = logBlock + 1; stage <= logN; ++stage) {
+        err = clSetKernelArg(fft.global, 4, sizeof(cl_int), &stage);
+        checkError(err, "clSetKernelArg 4 (stage)");
+        err = clEnqueueNDRangeKernel(queue, fft.global, 1, NULL, stageGlobalSize, stageLocalSize, 1,
+                                     &events.compute[stage - logBlock - 1], &events.compute[stage - logBlock]);
+        checkError(err, "clEnqueueNDRangeKernel (fft_global_stage)");
+    }
+
+    err = clEnqueueReadBuffer(queue, d_data, CL_FALSE, 0, sizeof(cl_float2) * N, h_out, 1, &events.compute.back(),
+                              &events.download);
+    checkError(err, "clEnqueueReadBuffer");
+    return events;
+}
+
+// Double-precision radix-2 stages over already bit-reversed data: the CPU reference
+void referenceFFT(std::vector<std::complex<double>>& data, const fft_plan& plan) {
+    const size_t n = data.size();
+    for (size_t half = 1; half < n; half *= 2) {
+        for (size_t k = 0; k < n; k += 2 * half) {
+            for (size_t j = 0; j < half; ++j) {
+                const std::complex<double> t = plan.twiddle(half, j) * data[k + j + half];
+                data[k + j + half] = data[k + j] - t;
+                data[k + j] += t;
+            }
+        }
+    }
+}
+
+double errorBound(int logN) {
+    return ERROR_ULPS_PER_STAGE * FLT_EPSILON * std::max(logN, 1);
+}
+
 // Function to load OpenCL kernel source code from file
 std::string loadKernelSource(const char* filename) {
     std::ifstream file(filename);
@@ -37,24 +199,36 @@ std::string loadKernelSource(const char* filename) {
     return source;
 }
 
-// Function to reverse bits (for bit-reversal permutation)
-unsigned int reverse_bits(unsigned int n, unsigned int bits) {
-    unsigned int reversed = 0;
-    for (unsigned int i = 0; i < bits; ++i) {
-        reversed <<= 1;
-        reversed |= (n & 1);
-        n >>= 1;
-    }
-    return reversed;
-}
-
 int main(int argc, char* argv[]) {
     std::string output_file_path;
+    arena_options arena_settings;
+    int max_size = 0;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--output-file" && i + 1 < argc) {
             output_file_path = argv[++i];
         }
+        else if (arg == "--max-size" && i + 1 < argc) {
+            max_size = std::atoi(argv[++i]);
+            if (max_size < 32) {
+                std::cerr << "Error: Invalid value for --max-size (expected at least 32)" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--pages" && i + 1 < argc) {
+            if (!buffer_arena::parse_page_mode(argv[++i], arena_settings.pages)) {
+                std::cerr << "Error: Invalid value for --pages (expected 4k|thp|hugetlb)" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--prefault" && i + 1 < argc) {
+            std::string prefault_arg = argv[++i];
+            if (prefault_arg != "on" && prefault_arg != "off") {
+                std::cerr << "Error: Invalid value for --prefault (expected on|off)" << std::endl;
+                return 1;
+            }
+            arena_settings.prefault = prefault_arg == "on";
+        }
     }
 
     if (output_file_path.empty()) {
@@ -68,18 +242,35 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    results_file_stream << "Input_Size,Time_ms" << std::endl;
-    // Define input sizes to be benchmarked (same as CPU for comparison)
-    const std::vector<int> INPUT_SIZES = {
+    // Time_ms is the fused FFT of one transform: the stages that fit a work-group's block in one
+    // launch from local memory, then one launch per wider stage, all with table twiddles;
+    // Launches counts them. Staged_Time_ms is one fft_kernel launch per stage, each waited for.
+    // Upload_ms, Permute_ms (the on-device bit reversal) and Download_ms are the other commands
+    // of the same transform and Wall_ms its host time from the first enqueue to the finished
+    // download. The streamed run pushes Stream_Transforms transforms round-robin through
+    // STREAM_QUEUES queues, so transfers and kernels of different transforms overlap.
+    // Page_Faults counts the host faults of the single transform, which follows one untimed
+    // transform of the same size. Max_Error is the largest error of any downloaded result
+    // (single, staged and streamed) against a double CPU transform of the same input,
+    // relative to its largest magnitude; the run fails if it exceeds errorBound for that size.
+    results_file_stream << "Input_Size,Time_ms,Launches,Staged_Time_ms,Upload_ms,Permute_ms,Download_ms,Wall_ms,"
+                           "Stream_Transforms,Stream_ms,Transforms_per_s,Page_Faults,Max_Error" << std::endl;
+    // Define input sizes to be benchmarked (same as CPU for comparison); --max-size drops the
+    // larger ones for a quick check run
+    std::vector<int> INPUT_SIZES = {
         32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384,
         32768, 65536, 131072, 262144, 524288, 1048576, 2097152, 4194304, 8388608, 16777216
     };
+    if (max_size > 0) {
+        std::erase_if(INPUT_SIZES, [&](int N) { return N > max_size; });
+    }
+    const int maxN = *std::max_element(INPUT_SIZES.begin(), INPUT_SIZES.end());
 
     cl_int err;
     cl_platform_id platform;
     cl_device_id device;
     cl_context context;
-    cl_command_queue queue;
+    cl_command_queue queues[STREAM_QUEUES];
     cl_program program;
     cl_kernel kernel;
 
@@ -104,9 +295,12 @@ int main(int argc, char* argv[]) {
     context = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
     checkError(err, "clCreateContext");
 
-    // 3. Create command queue
-    queue = clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err);
-    checkError(err, "clCreateCommandQueue");
+    // 3. Create command queues; queue 0 also runs the single-transform measurements
+    for (cl_command_queue& queue : queues) {
+        queue = clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+        checkError(err, "clCreateCommandQueue");
+    }
+    cl_command_queue queue = queues[0];
 
     // 4. Load and compile kernel
     std::string kernelSource = loadKernelSource(KERNEL_FILE_PATH);
@@ -126,53 +320,154 @@ int main(int argc, char* argv[]) {
     
     kernel = clCreateKernel(program, "fft_kernel", &err);
     checkError(err, "clCreateKernel");
+    FusedFFT fft;
+    fft.permute = clCreateKernel(program, "bit_reverse_permute", &err);
+    checkError(err, "clCreateKernel (bit_reverse_permute)");
+    fft.local = clCreateKernel(program, "fft_local_stages", &err);
+    checkError(err, "clCreateKernel (fft_local_stages)");
+    fft.global = clCreateKernel(program, "fft_global_stage", &err);
+    checkError(err, "clCreateKernel (fft_global_stage)");
+
+    // The fused block is bounded by the device's local memory, its work-group by the kernel's limit
+    cl_ulong localMemSize = 0;
+    clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(localMemSize), &localMemSize, NULL);
+    size_t kernelWorkGroupSize = 1;
+    clGetKernelWorkGroupInfo(fft.local, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize),
+                             &kernelWorkGroupSize, NULL);
+    fft.blockLimit = floorPow2(std::max<size_t>(2, std::min<size_t>(LOCAL_BLOCK_MAX,
+                                                                     localMemSize / sizeof(cl_float2))));
+    fft.localSizeLimit = floorPow2(std::max<size_t>(1, std::min(kernelWorkGroupSize, LOCAL_WORK_SIZE_MAX)));
+    std::cout << "Fused block: up to " << fft.blockLimit << " points, " << fft.localSizeLimit << " work-items"
+              << std::endl;
+
+    // 5. Persistent buffers, sized for the largest transform and reused by every size: the
+    //    twiddle table, one device buffer per queue, and host staging buffers from the arena
+    //    (page aligned, prefaulted) wrapped with CL_MEM_USE_HOST_PTR and kept mapped, so the
+    //    runtime can pin them and transfer without an intermediate copy
+    //    The table holds exp(-2 pi i j / maxN) for j < maxN / 2, each root rounded once to float
+    fft.tableN = maxN;
+    {
+        std::vector<cl_float2> h_twiddles(maxN / 2);
+        for (int j = 0; j < maxN / 2; ++j) {
+            const long double angle = -2.0L * std::numbers::pi_v<long double> * j / maxN;
+            h_twiddles[j] = { (cl_float)std::cos(angle), (cl_float)std::sin(angle) };
+        }
+        fft.twiddles = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                                      sizeof(cl_float2) * h_twiddles.size(), h_twiddles.data(), &err);
+        checkError(err, "clCreateBuffer (twiddles)");
+    }
+
+    cl_mem d_data[STREAM_QUEUES];
+    for (cl_mem& buffer : d_data) {
+        buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_float2) * maxN, NULL, &err);
+        checkError(err, "clCreateBuffer");
+    }
+
+    buffer_arena arena(arena_settings);
+    const size_t stagingBytes = sizeof(cl_float2) * maxN;
+    std::vector<buffer_arena::buffer> stagingMemory;
+    std::vector<cl_mem> stagingBuffers;
+    std::vector<cl_float2*> staging; // [0] is the input, [1 + q] the output of queue q
+    for (int b = 0; b < 1 + STREAM_QUEUES; ++b) {
+        stagingMemory.push_back(arena.acquire(stagingBytes));
+        cl_mem buffer = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, stagingBytes,
+                                       stagingMemory.back().data(), &err);
+        checkError(err, "clCreateBuffer (staging)");
+        void* mapped = clEnqueueMapBuffer(queue, buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, stagingBytes, 0,
+                                          NULL, NULL, &err);
+        checkError(err, "clEnqueueMapBuffer");
+        stagingBuffers.push_back(buffer);
+        staging.push_back(static_cast<cl_float2*>(mapped));
+    }
+    cl_float2* h_in = staging[0];
 
     std::cout << "Running GPU benchmark..." << std::endl;
+    bool all_valid = true;
 
     for (int N : INPUT_SIZES) {
+        int logN = 0;
+        while ((1 << logN) < N) ++logN; // N must be a power of 2 for this FFT
+
         // Generate random data (real part only for now, complex part 0)
-        std::vector<cl_float2> h_data(N); // Host data
         std::mt19937 gen(1234); // Fixed seed for reproducibility
         std::uniform_real_distribution<> dis(-1000.0, 1000.0);
         for (int i = 0; i < N; ++i) {
-            h_data[i] = { (cl_float)dis(gen), 0.0f };
+            h_in[i] = { (cl_float)dis(gen), 0.0f };
         }
 
-        // Perform bit-reversal permutation on host (or could be a separate kernel)
-        int logN = 0;
-        while ((1 << logN) < N) ++logN; // N must be a power of 2 for this FFT
-        
-        std::vector<cl_float2> h_data_permuted = h_data; // Copy for permutation
+        // 6. One transform end to end: upload, permutation, fused FFT, download. An untimed
+        //    transform first takes the first-enqueue costs of this size (kernel setup for the
+        //    new launch sizes, first touch of the buffers) out of the measured one.
+        TransformEvents warmup = enqueueTransform(queue, fft, d_data[0], h_in, staging[1], N);
+        err = clFinish(queue);
+        checkError(err, "clFinish");
+        releaseEvents(warmup);
+
+        const uint64_t faults_before = timing_harness::page_fault_count();
+        auto start_host = std::chrono::high_resolution_clock::now();
+        TransformEvents single = enqueueTransform(queue, fft, d_data[0], h_in, staging[1], N);
+        err = clFinish(queue);
+        checkError(err, "clFinish");
+        std::chrono::duration<double, std::milli> wall_duration = std::chrono::high_resolution_clock::now() - start_host;
+        const uint64_t page_faults = timing_harness::page_fault_count() - faults_before;
+
+        const double upload_ms = eventDurationMs(single.upload);
+        const double permute_ms = eventDurationMs(single.permute);
+        const double fused_kernel_duration_ms = eventsDurationMs(single.compute);
+        const double download_ms = eventDurationMs(single.download);
+        const size_t launches = single.compute.size();
+        releaseEvents(single);
+
+        // CPU reference, compared with the single result now and the streamed ones below
+        std::vector<std::complex<double>> reference(N);
         for (int i = 0; i < N; ++i) {
-            unsigned int reversed_i = reverse_bits(i, logN);
-            if (i < reversed_i) {
-                std::swap(h_data_permuted[i], h_data_permuted[reversed_i]);
-            }
+            reference[i] = { h_in[i].s[0], h_in[i].s[1] };
         }
-
-        // 5. Create device buffers
-        cl_mem d_data = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, 
-                                       sizeof(cl_float2) * N, h_data_permuted.data(), &err);
-        checkError(err, "clCreateBuffer");
-
-        // 6. Set kernel arguments that are constant across stages
-        err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &d_data);
+        bit_reversal_permutation::permute(reference.data(), reference.size());
+        {
+            const fft_plan plan(N, fft_direction::forward);
+            referenceFFT(reference, plan);
+        }
+        auto maxError = [&](const cl_float2* result) {
+            double max_diff = 0.0;
+            double max_ref = 0.0;
+            for (int i = 0; i < N; ++i) {
+                const std::complex<double> value(result[i].s[0], result[i].s[1]);
+                max_diff = std::max(max_diff, std::abs(value - reference[i]));
+                max_ref = std::max(max_ref, std::abs(reference[i]));
+            }
+            return max_ref > 0.0 ? max_diff / max_ref : max_diff;
+        };
+        double max_error = maxError(staging[1]);
+
+        // 7. Baseline: one fft_kernel launch per stage, blocking on each, after the same
+        //    upload and permutation
+        TransformEvents staged;
+        err = clEnqueueWriteBuffer(queue, d_data[0], CL_FALSE, 0, sizeof(cl_float2) * N, h_in, 0, NULL,
+                                   &staged.upload);
+        checkError(err, "clEnqueueWriteBuffer");
+        size_t permuteGlobalSize[1] = { (size_t)N };
+        size_t permuteLocalSize[1] = { std::min<size_t>(N, SIMPLE_WORK_SIZE) };
+        err = clSetKernelArg(fft.permute, 0, sizeof(cl_mem), &d_data[0]);
+        err |= clSetKernelArg(fft.permute, 1, sizeof(cl_int), &logN);
+        checkError(err, "clSetKernelArg (bit_reverse_permute)");
+        err = clEnqueueNDRangeKernel(queue, fft.permute, 1, NULL, permuteGlobalSize, permuteLocalSize, 1,
+                                     &staged.upload, &staged.permute);
+        checkError(err, "clEnqueueNDRangeKernel (bit_reverse_permute)");
+        err = clWaitForEvents(1, &staged.permute);
+        checkError(err, "clWaitForEvents");
+        clReleaseEvent(staged.upload);
+        clReleaseEvent(staged.permute);
+
+        err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &d_data[0]);
         checkError(err, "clSetKernelArg 0");
         err = clSetKernelArg(kernel, 1, sizeof(cl_int), &N);
         checkError(err, "clSetKernelArg 1");
 
-        // 7. Execute kernel for each stage
         size_t globalWorkSize[1] = { (size_t)N / 2 }; // Each work-item processes one butterfly
-        size_t localWorkSize[1] = { 64 }; // Smaller local work size for broader compatibility
+        size_t localWorkSize[1] = { std::min<size_t>(N / 2, SIMPLE_WORK_SIZE) };
 
-        // Ensure globalWorkSize is not smaller than localWorkSize for this simplified example
-        if (globalWorkSize[0] < localWorkSize[0]) {
-            localWorkSize[0] = globalWorkSize[0];
-        }
-        
         double total_kernel_duration_ms = 0;
-        auto start_host = std::chrono::high_resolution_clock::now();
-
         for (int stage = 1; stage <= logN; ++stage) {
             err = clSetKernelArg(kernel, 2, sizeof(cl_int), &stage);
             checkError(err, "clSetKernelArg 2 (stage)");
@@ -185,34 +480,82 @@ int main(int argc, char* argv[]) {
             checkError(err, "clWaitForEvents");
 
             // Get kernel execution time from event profiling
-            cl_ulong time_start, time_end;
-            clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &time_start, NULL);
-            clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &time_end, NULL);
-            total_kernel_duration_ms += (time_end - time_start) / 1000000.0;
+            total_kernel_duration_ms += eventDurationMs(event);
             clReleaseEvent(event);
         }
-        auto end_host = std::chrono::high_resolution_clock::now();
-
-        results_file_stream << N << "," << total_kernel_duration_ms << std::endl;
-        std::cout << "  Input size " << N << ": Kernel " << total_kernel_duration_ms << " ms" << std::endl;
-
-        // 8. Read results back (optional, for verification)
-        // std::vector<cl_float2> d_results(N);
-        // err = clEnqueueReadBuffer(queue, d_data, CL_TRUE, 0, sizeof(cl_float2) * N, d_results.data(), 0, NULL, NULL);
-        // checkError(err, "clEnqueueReadBuffer");
-
-        // 9. Clean up for this iteration
-        clReleaseMemObject(d_data);
+        err = clEnqueueReadBuffer(queue, d_data[0], CL_TRUE, 0, sizeof(cl_float2) * N, staging[1], 0, NULL, NULL);
+        checkError(err, "clEnqueueReadBuffer (staged)");
+        max_error = std::max(max_error, maxError(staging[1]));
+
+        // 8. A stream of transforms of the same input, round-robin over the queues. Commands
+        //    of one queue run in order, so a queue's device buffer and output staging buffer
+        //    are only reused once its previous transform has been downloaded.
+        const size_t streamTransforms = std::clamp<size_t>(STREAM_POINTS / N, 2 * STREAM_QUEUES,
+                                                            STREAM_TRANSFORMS_MAX);
+        std::vector<TransformEvents> streamEvents;
+        streamEvents.reserve(streamTransforms);
+        auto stream_start = std::chrono::high_resolution_clock::now();
+        for (size_t t = 0; t < streamTransforms; ++t) {
+            const int q = int(t % STREAM_QUEUES);
+            streamEvents.push_back(enqueueTransform(queues[q], fft, d_data[q], h_in, staging[1 + q], N));
+        }
+        for (cl_command_queue streamQueue : queues) {
+            err = clFinish(streamQueue);
+            checkError(err, "clFinish");
+        }
+        std::chrono::duration<double, std::milli> stream_duration =
+            std::chrono::high_resolution_clock::now() - stream_start;
+        for (TransformEvents& events : streamEvents) {
+            releaseEvents(events);
+        }
+        for (int q = 0; q < STREAM_QUEUES; ++q) {
+            max_error = std::max(max_error, maxError(staging[1 + q]));
+        }
+        const double transforms_per_s = streamTransforms / (stream_duration.count() / 1000.0);
+        const bool valid = max_error <= errorBound(logN);
+        all_valid = all_valid && valid;
+
+        results_file_stream << N << "," << fused_kernel_duration_ms << "," << launches << ","
+                            << total_kernel_duration_ms << "," << upload_ms << "," << permute_ms << ","
+                            << download_ms << "," << wall_duration.count() << "," << streamTransforms << ","
+                            << stream_duration.count() << "," << transforms_per_s << "," << page_faults << ","
+                            << max_error << std::endl;
+        std::cout << "  Input size " << N << ": Kernel " << fused_kernel_duration_ms << " ms in " << launches
+                  << " launches (per-stage " << total_kernel_duration_ms << " ms in " << logN << "), upload "
+                  << upload_ms << " ms, permute " << permute_ms << " ms, download " << download_ms << " ms, wall "
+                  << wall_duration.count() << " ms; stream of " << streamTransforms << ": "
+                  << transforms_per_s << " transforms/s; " << page_faults << " page faults, max error "
+                  << max_error << (valid ? "" : " FAILED VALIDATION") << std::endl;
     }
 
-    // 10. Clean up OpenCL resources
+    // 9. Clean up OpenCL resources
+    for (size_t b = 0; b < stagingBuffers.size(); ++b) {
+        clEnqueueUnmapMemObject(queue, stagingBuffers[b], staging[b], 0, NULL, NULL);
+    }
+    clFinish(queue);
+    for (cl_mem buffer : stagingBuffers) {
+        clReleaseMemObject(buffer);
+    }
+    for (cl_mem buffer : d_data) {
+        clReleaseMemObject(buffer);
+    }
+    clReleaseMemObject(fft.twiddles);
+    clReleaseKernel(fft.global);
+    clReleaseKernel(fft.local);
+    clReleaseKernel(fft.permute);
     clReleaseKernel(kernel);
     clReleaseProgram(program);
-    clReleaseCommandQueue(queue);
+    for (cl_command_queue streamQueue : queues) {
+        clReleaseCommandQueue(streamQueue);
+    }
     clReleaseContext(context);
     results_file_stream.close();
 
     std::cout << "GPU benchmark finished. Results saved to " << output_file_path << std::endl;
+    if (!all_valid) {
+        std::cerr << "ERROR: a result exceeded the float error bound" << std::endl;
+        return 1;
+    }
 
     return 0;
 }
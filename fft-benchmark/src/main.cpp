@@ -11,6 +11,17 @@ int main(int argc, char* argv[])
     string mode;
     unsigned int num_threads = 0;
     string output_file_path; // New variable for output file path
+    string input_file_path;
+    simd_isa isa = simd_fft::detect_isa();
+    fft_radix radix = fft_radix::radix2;
+    fft_precision precision = fft_precision::float64;
+    size_t memory_budget_mb = 1024;
+    harness_options harness_settings;
+    affinity_policy affinity = affinity_policy::none;
+    arena_options arena_settings;
+    window_kind window = window_kind::hann;
+    string wisdom_path = "fft_wisdom.txt";
+    unsigned int num_ranks = 4;
 
     for (int i = 1; i < argc; ++i)
     {
@@ -30,15 +41,146 @@ int main(int argc, char* argv[])
                 return 1;
             }
         }
+        else if (arg == "--ranks" && i + 1 < argc)
+        {
+            try
+            {
+                num_ranks = stoul(argv[++i]);
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for --ranks" << endl;
+                return 1;
+            }
+            if (num_ranks == 0 || (num_ranks & (num_ranks - 1)) != 0)
+            {
+                cerr << "Error: --ranks must be a power of two" << endl;
+                return 1;
+            }
+        }
         else if (arg == "--output-file" && i + 1 < argc) // New argument parsing
         {
             output_file_path = argv[++i];
         }
+        else if (arg == "--input-file" && i + 1 < argc)
+        {
+            input_file_path = argv[++i];
+        }
+        else if (arg == "--memory-mb" && i + 1 < argc)
+        {
+            try
+            {
+                memory_budget_mb = stoul(argv[++i]);
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for --memory-mb" << endl;
+                return 1;
+            }
+        }
+        else if ((arg == "--warmup" || arg == "--min-reps" || arg == "--max-reps") && i + 1 < argc)
+        {
+            try
+            {
+                const unsigned int value = stoul(argv[++i]);
+                if (arg == "--warmup") harness_settings.warmup_runs = value;
+                else if (arg == "--min-reps") harness_settings.min_repetitions = value;
+                else harness_settings.max_repetitions = value;
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for " << arg << endl;
+                return 1;
+            }
+        }
+        else if ((arg == "--target-ci" || arg == "--max-seconds") && i + 1 < argc)
+        {
+            try
+            {
+                const double value = stod(argv[++i]);
+                if (arg == "--target-ci") harness_settings.target_relative_ci = value;
+                else harness_settings.max_seconds = value;
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for " << arg << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--radix" && i + 1 < argc)
+        {
+            string radix_arg = argv[++i];
+            if (radix_arg == "2") radix = fft_radix::radix2;
+            else if (radix_arg == "4") radix = fft_radix::radix4;
+            else if (radix_arg == "split") radix = fft_radix::split;
+            else
+            {
+                cerr << "Error: Invalid value for --radix (expected 2|4|split)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--precision" && i + 1 < argc)
+        {
+            if (!benchmark::parse_precision(argv[++i], precision))
+            {
+                cerr << "Error: Invalid value for --precision (expected float|double|long-double)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--affinity" && i + 1 < argc)
+        {
+            if (!cpu_topology::parse_policy(argv[++i], affinity))
+            {
+                cerr << "Error: Invalid value for --affinity (expected none|compact|scatter|physical)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--pages" && i + 1 < argc)
+        {
+            if (!buffer_arena::parse_page_mode(argv[++i], arena_settings.pages))
+            {
+                cerr << "Error: Invalid value for --pages (expected 4k|thp|hugetlb)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--prefault" && i + 1 < argc)
+        {
+            string prefault_arg = argv[++i];
+            if (prefault_arg != "on" && prefault_arg != "off")
+            {
+                cerr << "Error: Invalid value for --prefault (expected on|off)" << endl;
+                return 1;
+            }
+            arena_settings.prefault = prefault_arg == "on";
+        }
+        else if (arg == "--wisdom" && i + 1 < argc)
+        {
+            wisdom_path = argv[++i];
+        }
+        else if (arg == "--window" && i + 1 < argc)
+        {
+            if (!streaming_stft::parse_window(argv[++i], window))
+            {
+                cerr << "Error: Invalid value for --window (expected rectangular|hann|hamming|blackman|blackman-harris)"
+                    << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--isa" && i + 1 < argc)
+        {
+            string isa_arg = argv[++i];
+            if (isa_arg != "auto" && !simd_fft::parse_isa(isa_arg, isa))
+            {
+                cerr << "Error: Invalid value for --isa (expected auto|scalar|sse2|avx2|avx512)" << endl;
+                return 1;
+            }
+            if (!simd_fft::is_supported(isa))
+            {
+                cerr << "Error: " << simd_fft::isa_name(isa) << " is not supported on this CPU" << endl;
+                return 1;
+            }
+        }
     }
 
     if (mode.empty())
     {
-        cerr << "Error: Please provide a mode with --mode [single|multi]" << endl;
+        cerr << "Error: Please provide a mode with --mode [single|multi|four-step|simd|mixed|real|convolution|batch|stft|multidim|tune|auto|scaling|distributed|out-of-core]" << endl;
         return 1;
     }
 
@@ -48,11 +190,59 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    if (precision != fft_precision::float64)
+    {
+        const bool scalar_mode = mode == "single" || mode == "multi";
+        if (!(scalar_mode && radix == fft_radix::radix2) && !(mode == "simd" && precision == fft_precision::float32))
+        {
+            cerr << "Error: --precision " << benchmark::precision_name(precision)
+                << " is only available in single/multi mode with radix 2, and float in simd mode" << endl;
+            return 1;
+        }
+    }
+
+    if (affinity != affinity_policy::none)
+    {
+        // physical defaults to one thread per core and refuses more
+        const cpu_topology topology;
+        if (num_threads == 0 && affinity == affinity_policy::physical)
+        {
+            num_threads = unsigned(topology.core_count());
+        }
+        if (affinity == affinity_policy::physical && num_threads > topology.core_count())
+        {
+            cerr << "Error: --affinity physical allows at most " << topology.core_count()
+                << " threads (one per physical core)" << endl;
+            return 1;
+        }
+    }
+
     benchmark bench;
+    bench.set_harness_options(harness_settings);
+    bench.set_affinity_policy(affinity);
+    bench.set_arena_options(arena_settings);
+
+    if (!input_file_path.empty())
+    {
+        if ((mode != "single" && mode != "multi" && mode != "auto" && mode != "out-of-core") || precision != fft_precision::float64)
+        {
+            cerr << "Error: --input-file is only available in single/multi/auto/out-of-core mode with double precision"
+                << endl;
+            return 1;
+        }
+        try
+        {
+            bench.set_input_file(input_file_path);
+        } catch (const std::exception& e)
+        {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
 
     if (mode == "single")
     {
-        bench.run_single_threaded_benchmark(output_file_path); // Pass output_file_path
+        bench.run_single_threaded_benchmark(output_file_path, radix, precision);
     }
     else if (mode == "multi")
     {
@@ -60,7 +250,96 @@ int main(int argc, char* argv[])
         {
             num_threads = std::thread::hardware_concurrency();
         }
-        bench.run_multithreaded_benchmark(output_file_path, num_threads); // Pass output_file_path and num_threads
+        if (radix == fft_radix::split)
+        {
+            cerr << "Error: split-radix is only available in single mode" << endl;
+            return 1;
+        }
+        bench.run_multithreaded_benchmark(output_file_path, num_threads, radix, precision);
+    }
+    else if (mode == "four-step")
+    {
+        bench.run_four_step_benchmark(output_file_path);
+    }
+    else if (mode == "simd")
+    {
+        bench.run_simd_benchmark(output_file_path, isa, precision);
+    }
+    else if (mode == "mixed")
+    {
+        bench.run_mixed_radix_benchmark(output_file_path);
+    }
+    else if (mode == "real")
+    {
+        bench.run_real_benchmark(output_file_path);
+    }
+    else if (mode == "convolution")
+    {
+        bench.run_convolution_benchmark(output_file_path);
+    }
+    else if (mode == "batch")
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        bench.run_batch_benchmark(output_file_path, num_threads, isa);
+    }
+    else if (mode == "stft")
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        bench.run_stft_benchmark(output_file_path, num_threads, isa, window);
+    }
+    else if (mode == "multidim")
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        bench.run_multidim_benchmark(output_file_path, num_threads, isa);
+    }
+    else if (mode == "scaling")
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        bench.run_scaling_benchmark(output_file_path, num_threads);
+    }
+    else if (mode == "tune" || mode == "auto")
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        if (mode == "tune")
+        {
+            bench.run_tune_benchmark(output_file_path, wisdom_path, num_threads, isa);
+        }
+        else
+        {
+            bench.run_auto_benchmark(output_file_path, wisdom_path, num_threads);
+        }
+    }
+    else if (mode == "distributed")
+    {
+        bench.run_distributed_benchmark(output_file_path, num_ranks, isa);
+    }
+    else if (mode == "out-of-core")
+    {
+        if (input_file_path.empty())
+        {
+            cerr << "Error: out-of-core mode needs --input-file (generate_input --format binary --complex)" << endl;
+            return 1;
+        }
+        if (num_threads == 0)
+        {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        bench.run_out_of_core_benchmark(output_file_path, num_threads, memory_budget_mb);
     }
 
     return 0;
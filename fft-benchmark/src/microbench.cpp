@@ -0,0 +1,349 @@
+// Microbenchmarks of the FFT building blocks in isolation: bit reversal, one butterfly stage
+// per stride, one full transform per engine and the thread pool's dispatch cost. Each
+// benchmark is one CSV row of timing statistics; scripts/compare_microbench.py tests a run
+// against a stored baseline and flags the rows that got significantly slower. The baseline
+// (results/microbench/baseline.csv, --threads 1) is only comparable with runs of the same
+// timing_harness, so it is recorded again with any change to how the harness measures.
+#include "batched_fft.h"
+#include "benchmark.h"
+#include "bit_reversal.h"
+#include "cpu_topology.h"
+#include "fft_plan.h"
+#include "fft_tuner.h"
+#include "mixed_radix_fft.h"
+#include "real_fft.h"
+#include "thread_pool.h"
+#include "timing_harness.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // Single-stage and permutation sizes: one within L2, one well past the last-level cache
+    const vector<size_t> STAGE_SIZES = {size_t(1) << 16, size_t(1) << 20};
+    const vector<size_t> PERMUTE_SIZES = {size_t(1) << 10, size_t(1) << 16, size_t(1) << 20, size_t(1) << 22};
+    const vector<size_t> TRANSFORM_SIZES = {size_t(1) << 10, size_t(1) << 16, size_t(1) << 20};
+    // Non-power-of-two sizes: 3^2 * 5^3 and 2^10 * 3 for mixed radix, primes for Bluestein
+    const vector<size_t> MIXED_SIZES = {1125, 3072};
+    const vector<size_t> BLUESTEIN_SIZES = {1009, 65537};
+    constexpr size_t BATCH_SIZE = 1024;
+    constexpr size_t BATCH_COUNT = 64;
+    // Indices reversed per reverse_bits run
+    constexpr size_t REVERSE_COUNT = size_t(1) << 16;
+
+    // Keeps results the compiler could otherwise prove unused
+    volatile uint32_t sink;
+
+    vector<complex<double>> random_signal(size_t n)
+    {
+        mt19937 gen(12345);
+        uniform_real_distribution<double> dist(-1.0, 1.0);
+        vector<complex<double>> data(n);
+        for (auto& value : data)
+        {
+            value = complex<double>(dist(gen), dist(gen));
+        }
+        return data;
+    }
+
+    // "radix4-x8", "simd-avx2", "four-step-rows32", "radix2-tile4096": describe() without
+    // spaces or slashes, so the name stays one path component and each candidate has its own
+    string engine_label(const fft_choice& choice)
+    {
+        string label = tuned_fft::engine_name(choice.engine);
+        if (choice.engine == fft_engine::simd) label += string("-") + simd_fft::isa_name(choice.isa);
+        if (choice.threads > 1) label += "-x" + to_string(choice.threads);
+        if (choice.block != 0)
+        {
+            if (choice.engine == fft_engine::four_step) label += "-rows";
+            else if (choice.engine == fft_engine::depth_first) label += "-block";
+            else label += "-tile";
+            label += to_string(choice.block);
+        }
+        return label;
+    }
+
+    // Runs the benchmarks whose name contains the filter and writes one row each:
+    // Benchmark,Repetitions,Runs_per_Sample,Min_ms,Median_ms,Mean_ms,Stddev_ms,P99_ms
+    class microbench_suite {
+    public:
+        microbench_suite(ostream& output, string name_filter, const harness_options& settings)
+            : out(output), filter(move(name_filter)), harness(settings)
+        {
+        }
+
+        bool wants(const string& name) const { return filter.empty() || name.find(filter) != string::npos; }
+
+        void measure(const string& name, const function<void()>& setup, const function<void()>& run)
+        {
+            if (!wants(name)) return;
+            const timing_stats stats = harness.measure(setup, run);
+            out << name << "," << stats.repetitions << "," << stats.runs_per_sample << "," << stats.min_ms << ","
+                << stats.median_ms << "," << stats.mean_ms << "," << stats.stddev_ms << "," << stats.p99_ms << endl;
+            cout << "  " << name << ": " << stats.median_ms << " ms (" << stats.repetitions << " reps)" << endl;
+            ++count;
+        }
+
+        thread_pool& pool(unsigned int threads)
+        {
+            auto& slot = pools[threads];
+            if (!slot) slot = make_unique<thread_pool>(threads);
+            return *slot;
+        }
+
+        size_t measured() const { return count; }
+
+    private:
+        ostream& out;
+        string filter;
+        timing_harness harness;
+        map<unsigned int, unique_ptr<thread_pool>> pools;
+        size_t count = 0;
+    };
+
+    void run_bit_reversal(microbench_suite& suite, unsigned int max_threads)
+    {
+        for (unsigned int bits : {8u, 16u, 24u})
+        {
+            suite.measure("reverse_bits/" + to_string(bits), [] {}, [bits]
+            {
+                uint32_t acc = 0;
+                for (uint32_t i = 0; i < REVERSE_COUNT; ++i)
+                {
+                    acc ^= bit_reversal_permutation::reverse(i, bits);
+                }
+                sink = acc;
+            });
+        }
+
+        // The permutation is an involution, so repeated runs need no setup
+        for (size_t n : PERMUTE_SIZES)
+        {
+            const string serial = "permute/serial/" + to_string(n);
+            const string pooled = "permute/pool-x" + to_string(max_threads) + "/" + to_string(n);
+            if (!suite.wants(serial) && !suite.wants(pooled)) continue;
+            vector<complex<double>> data = random_signal(n);
+            suite.measure(serial, [] {}, [&] { bit_reversal_permutation::permute(data.data(), n); });
+            if (max_threads > 1)
+            {
+                thread_pool& pool = suite.pool(max_threads);
+                suite.measure(pooled, [] {}, [&] { bit_reversal_permutation::permute(data.data(), n, pool); });
+            }
+        }
+    }
+
+    void run_stages(microbench_suite& suite)
+    {
+        for (size_t n : STAGE_SIZES)
+        {
+            const auto plan = fft_plan::get(n);
+            const vector<complex<double>> input = random_signal(n);
+            vector<complex<double>> data(n);
+            // Restored before every sample so repeated stages cannot grow the values out of range
+            auto setup = [&] { std::copy(input.begin(), input.end(), data.begin()); };
+            for (size_t half = 1; half < n; half <<= 1)
+            {
+                suite.measure("stage/" + to_string(n) + "/half=" + to_string(half), setup,
+                              [&] { benchmark::fft_stage(data, *plan, half); });
+            }
+        }
+    }
+
+    void run_transforms(microbench_suite& suite, unsigned int max_threads, simd_isa isa)
+    {
+        for (size_t n : TRANSFORM_SIZES)
+        {
+            const vector<complex<double>> input = random_signal(n);
+            vector<complex<double>> data(n);
+            auto setup = [&] { std::copy(input.begin(), input.end(), data.begin()); };
+            for (const fft_choice& choice : tuned_fft::candidates(n, max_threads, isa))
+            {
+                const string name = "transform/" + engine_label(choice) + "/" + to_string(n);
+                if (!suite.wants(name)) continue;
+                tuned_fft engine(n, choice);
+                thread_pool* pool = choice.threads > 1 ? &suite.pool(choice.threads) : nullptr;
+                suite.measure(name, setup, [&] { engine.execute(data, pool); });
+            }
+        }
+
+        // In-place engines behind a shared_ptr from their get(): restore the input, transform
+        auto measure_in_place = [&](const string& name, size_t n, auto get_engine)
+        {
+            if (!suite.wants(name)) return;
+            const auto engine = get_engine(n);
+            const vector<complex<double>> input = random_signal(n);
+            vector<complex<double>> data(n);
+            suite.measure(name, [&] { std::copy(input.begin(), input.end(), data.begin()); },
+                          [&] { engine->execute(data); });
+        };
+        for (size_t n : MIXED_SIZES)
+        {
+            measure_in_place("transform/mixed/" + to_string(n), n,
+                             [](size_t size) { return mixed_radix_fft::get(size); });
+        }
+        for (size_t n : BLUESTEIN_SIZES)
+        {
+            measure_in_place("transform/bluestein/" + to_string(n), n,
+                             [](size_t size) { return bluestein_fft::get(size); });
+        }
+        for (size_t n : TRANSFORM_SIZES)
+        {
+            const string name = "transform/real/" + to_string(n);
+            if (!suite.wants(name)) continue;
+            const auto engine = real_fft::get(n);
+            const vector<complex<double>> signal = random_signal(n);
+            vector<double> input(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                input[i] = signal[i].real();
+            }
+            vector<complex<double>> spectrum(engine->spectrum_size());
+            suite.measure(name, [] {}, [&] { engine->forward(input, spectrum); });
+        }
+
+        const string batch_name = "transform/batched-" + string(simd_fft::isa_name(isa)) + "/" +
+            to_string(BATCH_COUNT) + "x" + to_string(BATCH_SIZE);
+        if (!suite.wants(batch_name)) return;
+        const batched_fft batched(BATCH_SIZE, fft_direction::forward, isa);
+        const vector<complex<double>> batch_input = random_signal(BATCH_SIZE * BATCH_COUNT);
+        vector<complex<double>> batch_data(batch_input.size());
+        suite.measure(batch_name, [&] { std::copy(batch_input.begin(), batch_input.end(), batch_data.begin()); },
+                      [&] { batched.execute(batch_data.data(), BATCH_COUNT); });
+    }
+
+    // An empty job split across every participant: wake, distribute and join, nothing else
+    void run_dispatch(microbench_suite& suite, unsigned int max_threads)
+    {
+        for (unsigned int threads = 2; threads < 2 * max_threads; threads *= 2)
+        {
+            const unsigned int count = std::min(threads, max_threads);
+            const string name = "dispatch/x" + to_string(count);
+            if (suite.wants(name))
+            {
+                thread_pool& pool = suite.pool(count);
+                suite.measure(name, [] {}, [&] { pool.parallel_for(pool.size(), 1, [](size_t, size_t) {}); });
+            }
+            if (count == max_threads) break;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    string output_file_path;
+    string filter;
+    unsigned int num_threads = 0;
+    simd_isa isa = simd_fft::detect_isa();
+    // Short budgets and more repetitions than the main benchmark: many small rows, and the
+    // compare tool wants enough samples per row for its t-test
+    harness_options harness_settings;
+    harness_settings.min_repetitions = 10;
+    harness_settings.max_seconds = 0.5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--output-file" && i + 1 < argc)
+        {
+            output_file_path = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            try
+            {
+                num_threads = stoul(argv[++i]);
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for --threads" << endl;
+                return 1;
+            }
+        }
+        else if ((arg == "--warmup" || arg == "--min-reps" || arg == "--max-reps") && i + 1 < argc)
+        {
+            try
+            {
+                const unsigned int value = stoul(argv[++i]);
+                if (arg == "--warmup") harness_settings.warmup_runs = value;
+                else if (arg == "--min-reps") harness_settings.min_repetitions = value;
+                else harness_settings.max_repetitions = value;
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for " << arg << endl;
+                return 1;
+            }
+        }
+        else if ((arg == "--target-ci" || arg == "--max-seconds") && i + 1 < argc)
+        {
+            try
+            {
+                const double value = stod(argv[++i]);
+                if (arg == "--target-ci") harness_settings.target_relative_ci = value;
+                else harness_settings.max_seconds = value;
+            } catch (const std::exception& e)
+            {
+                cerr << "Error: Invalid number for " << arg << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--isa" && i + 1 < argc)
+        {
+            string isa_arg = argv[++i];
+            if (isa_arg != "auto" && !simd_fft::parse_isa(isa_arg, isa))
+            {
+                cerr << "Error: Invalid value for --isa (expected auto|scalar|sse2|avx2|avx512)" << endl;
+                return 1;
+            }
+            if (!simd_fft::is_supported(isa))
+            {
+                cerr << "Error: " << simd_fft::isa_name(isa) << " is not supported on this CPU" << endl;
+                return 1;
+            }
+        }
+    }
+
+    if (output_file_path.empty())
+    {
+        cerr << "Error: Please provide an output file path with --output-file" << endl;
+        return 1;
+    }
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ofstream results_file_stream(output_file_path);
+    if (!results_file_stream.is_open())
+    {
+        cerr << "Error: Could not open output file " << output_file_path << endl;
+        return 1;
+    }
+
+    // The compare tool warns when a baseline comes from another CPU or thread count
+    results_file_stream << "# model: " << cpu_topology::model_name() << endl;
+    results_file_stream << "# threads: " << num_threads << endl;
+    results_file_stream << "# isa: " << simd_fft::isa_name(isa) << endl;
+    results_file_stream << "Benchmark,Repetitions,Runs_per_Sample,Min_ms,Median_ms,Mean_ms,Stddev_ms,P99_ms" << endl;
+
+    microbench_suite suite(results_file_stream, filter, harness_settings);
+    cout << "Running microbenchmarks (" << num_threads << " threads, " << simd_fft::isa_name(isa) << ")..." << endl;
+    run_bit_reversal(suite, num_threads);
+    run_stages(suite);
+    run_transforms(suite, num_threads, isa);
+    run_dispatch(suite, num_threads);
+
+    results_file_stream.close();
+    cout << suite.measured() << " microbenchmarks finished. Results saved to " << output_file_path << endl;
+    return 0;
+}
@@ -0,0 +1,292 @@
+#include "mixed_radix_fft.h"
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace
+{
+    // i * z * sign, where sign is -1 for the forward and +1 for the inverse transform
+    inline complex<double> rotate(complex<double> z, double sign)
+    {
+        return {-sign * z.imag(), sign * z.real()};
+    }
+
+    // Length-R DFT of a[0..R-1] into b[0..R-1]. roots[k] = W_R^k for the generic case.
+    template <size_t R>
+    inline void small_dft(const complex<double>* a, complex<double>* b, double sign, const complex<double>* roots)
+    {
+        if constexpr (R == 2)
+        {
+            b[0] = a[0] + a[1];
+            b[1] = a[0] - a[1];
+        }
+        else if constexpr (R == 3)
+        {
+            constexpr double sin60 = 0.86602540378443864676;
+            const complex<double> sum = a[1] + a[2];
+            const complex<double> mid = a[0] - 0.5 * sum;
+            const complex<double> rot = rotate(sin60 * (a[1] - a[2]), sign);
+            b[0] = a[0] + sum;
+            b[1] = mid + rot;
+            b[2] = mid - rot;
+        }
+        else if constexpr (R == 4)
+        {
+            const complex<double> s02 = a[0] + a[2];
+            const complex<double> d02 = a[0] - a[2];
+            const complex<double> s13 = a[1] + a[3];
+            const complex<double> d13 = rotate(a[1] - a[3], sign);
+            b[0] = s02 + s13;
+            b[1] = d02 + d13;
+            b[2] = s02 - s13;
+            b[3] = d02 - d13;
+        }
+        else if constexpr (R == 5)
+        {
+            constexpr double c1 = 0.30901699437494742410;  // cos(2pi/5)
+            constexpr double c2 = -0.80901699437494742410; // cos(4pi/5)
+            constexpr double s1 = 0.95105651629515357212;  // sin(2pi/5)
+            constexpr double s2 = 0.58778525229247312917;  // sin(4pi/5)
+            const complex<double> sum14 = a[1] + a[4];
+            const complex<double> sum23 = a[2] + a[3];
+            const complex<double> diff14 = a[1] - a[4];
+            const complex<double> diff23 = a[2] - a[3];
+            const complex<double> t1 = a[0] + c1 * sum14 + c2 * sum23;
+            const complex<double> t2 = a[0] + c2 * sum14 + c1 * sum23;
+            const complex<double> u1 = rotate(s1 * diff14 + s2 * diff23, sign);
+            const complex<double> u2 = rotate(s2 * diff14 - s1 * diff23, sign);
+            b[0] = a[0] + sum14 + sum23;
+            b[1] = t1 + u1;
+            b[4] = t1 - u1;
+            b[2] = t2 + u2;
+            b[3] = t2 - u2;
+        }
+        else
+        {
+            for (size_t u = 0; u < R; ++u)
+            {
+                complex<double> acc = a[0];
+                for (size_t t = 1; t < R; ++t)
+                {
+                    acc += a[t] * roots[(t * u) % R];
+                }
+                b[u] = acc;
+            }
+        }
+    }
+
+    // One Stockham DIF pass: for p < len/R and q < stride,
+    //   y[q + stride * (R*p + u)] = W_len^(p*u) * sum_t x[q + stride * (p + t*len/R)] * W_R^(t*u)
+    template <size_t R>
+    void stockham_pass(const complex<double>* x, complex<double>* y, size_t len, size_t stride,
+                       const complex<double>* twiddles, double sign)
+    {
+        const size_t m = len / R;
+        complex<double> roots[R];
+        for (size_t k = 0; k < R; ++k)
+        {
+            roots[k] = polar(1.0, sign * 2 * M_PI * double(k) / double(R));
+        }
+
+        complex<double> a[R];
+        complex<double> b[R];
+        for (size_t p = 0; p < m; ++p)
+        {
+            const complex<double>* w = twiddles + p * (R - 1);
+            for (size_t q = 0; q < stride; ++q)
+            {
+                for (size_t t = 0; t < R; ++t)
+                {
+                    a[t] = x[q + stride * (p + t * m)];
+                }
+                small_dft<R>(a, b, sign, roots);
+                complex<double>* out = y + q + stride * R * p;
+                out[0] = b[0];
+                for (size_t u = 1; u < R; ++u)
+                {
+                    out[stride * u] = b[u] * w[u - 1];
+                }
+            }
+        }
+    }
+
+    template <typename Plan>
+    shared_ptr<const Plan> get_cached(size_t size, fft_direction direction)
+    {
+        static mutex cache_mutex;
+        static map<pair<size_t, fft_direction>, shared_ptr<const Plan>> cache;
+        lock_guard<mutex> lock(cache_mutex);
+        auto& plan = cache[{size, direction}];
+        if (!plan)
+        {
+            plan = make_shared<const Plan>(size, direction);
+        }
+        return plan;
+    }
+}
+
+mixed_radix_fft::mixed_radix_fft(size_t size, fft_direction direction)
+    : n(size), dir(direction)
+{
+    if (!is_smooth(n))
+    {
+        throw invalid_argument("mixed_radix_fft: size " + to_string(n) + " has a prime factor above 7");
+    }
+
+    // Radix-4 passes first (fewest passes for the power-of-two part), then 2, 3, 5, 7
+    size_t rest = n;
+    while (rest % 4 == 0)
+    {
+        radices.push_back(4);
+        rest /= 4;
+    }
+    for (size_t radix : {2, 3, 5, 7})
+    {
+        while (rest % radix == 0)
+        {
+            radices.push_back(radix);
+            rest /= radix;
+        }
+    }
+
+    const double sign = (dir == fft_direction::forward) ? -1.0 : 1.0;
+    size_t len = n;
+    for (size_t radix : radices)
+    {
+        const size_t m = len / radix;
+        twiddle_offsets.push_back(twiddles.size());
+        for (size_t p = 0; p < m; ++p)
+        {
+            for (size_t u = 1; u < radix; ++u)
+            {
+                twiddles.push_back(polar(1.0, sign * 2 * M_PI * double(p * u) / double(len)));
+            }
+        }
+        len = m;
+    }
+}
+
+bool mixed_radix_fft::is_smooth(size_t size)
+{
+    if (size == 0) return false;
+    for (size_t radix : {2, 3, 5, 7})
+    {
+        while (size % radix == 0) size /= radix;
+    }
+    return size == 1;
+}
+
+void mixed_radix_fft::execute(span<complex<double>> data) const
+{
+    if (data.size() != n)
+    {
+        throw invalid_argument("mixed_radix_fft: data size does not match the plan");
+    }
+
+    thread_local vector<complex<double>> scratch;
+    scratch.resize(n);
+
+    const double sign = (dir == fft_direction::forward) ? -1.0 : 1.0;
+    complex<double>* x = data.data();
+    complex<double>* y = scratch.data();
+    size_t len = n;
+    size_t stride = 1;
+    for (size_t s = 0; s < radices.size(); ++s)
+    {
+        const complex<double>* w = twiddles.data() + twiddle_offsets[s];
+        switch (radices[s])
+        {
+        case 2: stockham_pass<2>(x, y, len, stride, w, sign); break;
+        case 3: stockham_pass<3>(x, y, len, stride, w, sign); break;
+        case 4: stockham_pass<4>(x, y, len, stride, w, sign); break;
+        case 5: stockham_pass<5>(x, y, len, stride, w, sign); break;
+        case 7: stockham_pass<7>(x, y, len, stride, w, sign); break;
+        }
+        swap(x, y);
+        len /= radices[s];
+        stride *= radices[s];
+    }
+
+    if (x != data.data())
+    {
+        std::copy(x, x + n, data.data());
+    }
+}
+
+shared_ptr<const mixed_radix_fft> mixed_radix_fft::get(size_t size, fft_direction direction)
+{
+    return get_cached<mixed_radix_fft>(size, direction);
+}
+
+bluestein_fft::bluestein_fft(size_t size, fft_direction direction)
+    : n(size), m(1)
+{
+    if (n == 0)
+    {
+        throw invalid_argument("bluestein_fft: size must be positive");
+    }
+    while (m < 2 * n - 1) m <<= 1;
+    forward_plan = fft_plan::get(m, fft_direction::forward);
+
+    // k^2 is reduced mod 2N before scaling so the angle stays exact for large k
+    const double sign = (direction == fft_direction::forward) ? -1.0 : 1.0;
+    chirp.resize(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        const uint64_t k2 = (uint64_t(k) * k) % (2 * uint64_t(n));
+        chirp[k] = polar(1.0, sign * M_PI * double(k2) / double(n));
+    }
+
+    // b[j] = conj(chirp[|j|]) for -N < j < N, wrapped circularly into length M
+    filter_spectrum.assign(m, complex<double>(0.0, 0.0));
+    filter_spectrum[0] = conj(chirp[0]);
+    for (size_t k = 1; k < n; ++k)
+    {
+        filter_spectrum[k] = conj(chirp[k]);
+        filter_spectrum[m - k] = conj(chirp[k]);
+    }
+    benchmark::fft_radix4(filter_spectrum, *forward_plan);
+    for (auto& value : filter_spectrum)
+    {
+        value /= double(m);
+    }
+}
+
+void bluestein_fft::execute(span<complex<double>> data) const
+{
+    if (data.size() != n)
+    {
+        throw invalid_argument("bluestein_fft: data size does not match the plan");
+    }
+
+    thread_local vector<complex<double>> work;
+    work.assign(m, complex<double>(0.0, 0.0));
+
+    // X_k = chirp_k * sum_j (x_j * chirp_j) * conj(chirp_(k-j))
+    for (size_t k = 0; k < n; ++k)
+    {
+        work[k] = data[k] * chirp[k];
+    }
+    benchmark::fft_radix4(work, *forward_plan);
+    for (size_t k = 0; k < m; ++k)
+    {
+        work[k] *= filter_spectrum[k];
+    }
+    benchmark::fft_inverse(work, *forward_plan, false);
+    for (size_t k = 0; k < n; ++k)
+    {
+        data[k] = work[k] * chirp[k];
+    }
+}
+
+shared_ptr<const bluestein_fft> bluestein_fft::get(size_t size, fft_direction direction)
+{
+    return get_cached<bluestein_fft>(size, direction);
+}
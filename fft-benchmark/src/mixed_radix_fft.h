@@ -0,0 +1,59 @@
+#pragma once
+
+#include "fft_plan.h"
+
+#include <complex>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+// Self-sorting (Stockham) FFT for lengths whose prime factors are all 2, 3, 5 or 7.
+// The length is factored into radix-4/2/3/5/7 passes that ping-pong between the data and
+// a scratch buffer, so no bit-reversal is needed and no zero-padding either.
+class mixed_radix_fft {
+public:
+    mixed_radix_fft(size_t size, fft_direction direction);
+
+    void execute(span<complex<double>> data) const;
+
+    size_t size() const { return n; }
+    fft_direction direction() const { return dir; }
+    const vector<size_t>& factors() const { return radices; }
+
+    // True when size factors completely into 2, 3, 5 and 7
+    static bool is_smooth(size_t size);
+
+    static shared_ptr<const mixed_radix_fft> get(size_t size, fft_direction direction = fft_direction::forward);
+
+private:
+    size_t n;
+    fft_direction dir;
+    vector<size_t> radices;
+    // Stage s owns (len_s / r_s) * (r_s - 1) twiddles W_len^(p*u), starting at twiddle_offsets[s]
+    vector<size_t> twiddle_offsets;
+    vector<complex<double>> twiddles;
+};
+
+// Bluestein's chirp-z FFT for any length, in particular ones with large prime factors.
+// The length-N DFT becomes a circular convolution of length M >= 2N - 1 (a power of two)
+// with a fixed chirp, whose spectrum is computed once per plan.
+class bluestein_fft {
+public:
+    bluestein_fft(size_t size, fft_direction direction);
+
+    void execute(span<complex<double>> data) const;
+
+    size_t size() const { return n; }
+    size_t convolution_size() const { return m; }
+
+    static shared_ptr<const bluestein_fft> get(size_t size, fft_direction direction = fft_direction::forward);
+
+private:
+    size_t n;
+    size_t m;
+    vector<complex<double>> chirp;          // exp(-+i*pi*k^2 / N), k < N
+    vector<complex<double>> filter_spectrum; // FFT_M of the conjugate chirp, pre-scaled by 1/M
+    shared_ptr<const fft_plan> forward_plan; // both directions of the length-M convolution
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "batched_fft.h"
+#include "fft_plan.h"
+#include "fft_simd.h"
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+class thread_pool;
+
+// DFT of a row-major array of any rank (2D images, 3D volumes) with power-of-two sides.
+// Each pass transforms the contiguous last axis with the batched engine, one frame per
+// row, then moves the next axis into last place with a blocked transpose of the
+// [rows][last] view; after one pass per axis the array is back in its own layout. Column
+// passes thus read whole rows instead of striding through memory. The passes ping-pong
+// between the caller's buffer and a scratch copy, so an odd rank ends with one copy back.
+// With a pool, the row transforms and the transpose tiles are spread over the participants.
+class multidim_fft {
+public:
+    multidim_fft(const vector<size_t>& shape, fft_direction direction = fft_direction::forward,
+                 simd_isa isa = simd_fft::detect_isa());
+
+    void execute(complex<double>* data, thread_pool* pool = nullptr);
+    // Same transform without transposes: each axis runs in place through the batched engine's
+    // strided gather, one call per slab above it. Kept as the comparison point.
+    void execute_strided(complex<double>* data, thread_pool* pool = nullptr) const;
+
+    size_t size() const { return total; }
+    const vector<size_t>& shape() const { return dims; }
+
+    // Out-of-place transpose of a rows x cols row-major matrix, tile by tile, tiles spread
+    // over the pool
+    static void transpose(const complex<double>* src, complex<double>* dst, size_t rows, size_t cols,
+                          thread_pool* pool = nullptr);
+
+private:
+    vector<size_t> dims;
+    size_t total;
+    vector<batched_fft> engines; // one per axis
+    vector<complex<double>> scratch;
+};
@@ -0,0 +1,321 @@
+#include "out_of_core_fft.h"
+
+#include "benchmark.h"
+#include "four_step_fft.h"
+#include "signal_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    // Smallest number of panel columns or rows handed to one participant at a time
+    constexpr size_t MIN_TRANSFORMS_PER_TASK = 1;
+
+    // Owns a file descriptor for the duration of one pass
+    struct scoped_file
+    {
+        int fd = -1;
+
+        scoped_file(const string& path, int flags) : fd(open(path.c_str(), flags, 0644))
+        {
+            if (fd < 0)
+            {
+                throw runtime_error("out_of_core_fft: cannot open " + path + ": " + strerror(errno));
+            }
+        }
+        ~scoped_file() { close(fd); }
+
+        scoped_file(const scoped_file&) = delete;
+        scoped_file& operator=(const scoped_file&) = delete;
+    };
+
+    void read_exact(int fd, void* data, size_t bytes, uint64_t offset)
+    {
+        char* out = static_cast<char*>(data);
+        while (bytes > 0)
+        {
+            const ssize_t got = pread(fd, out, bytes, off_t(offset));
+            if (got <= 0)
+            {
+                throw runtime_error(string("out_of_core_fft: read failed: ") + (got == 0 ? "end of file" : strerror(errno)));
+            }
+            out += got;
+            bytes -= size_t(got);
+            offset += uint64_t(got);
+        }
+    }
+
+    void write_exact(int fd, const void* data, size_t bytes, uint64_t offset)
+    {
+        const char* in = static_cast<const char*>(data);
+        while (bytes > 0)
+        {
+            const ssize_t put = pwrite(fd, in, bytes, off_t(offset));
+            if (put < 0)
+            {
+                throw runtime_error(string("out_of_core_fft: write failed: ") + strerror(errno));
+            }
+            in += put;
+            bytes -= size_t(put);
+            offset += uint64_t(put);
+        }
+    }
+
+    size_t floor_power_of_two(size_t x)
+    {
+        size_t p = 1;
+        while (p * 2 <= x) p *= 2;
+        return x == 0 ? 0 : p;
+    }
+
+    using panel = vector<complex<double>>;
+
+    // Runs load -> compute -> store over `count` panels with three rotating buffers: panel
+    // i + 1 is read and panel i - 1 written on background threads while panel i is computed.
+    // Returns the time the calling thread spent blocked on I/O, in milliseconds.
+    double run_pipeline(size_t count, panel (&buffers)[3],
+                        const function<void(size_t, panel&)>& load,
+                        const function<void(size_t, panel&)>& compute,
+                        const function<void(size_t, const panel&)>& store)
+    {
+        double wait_ms = 0.0;
+        auto wait = [&](future<void>& pending)
+        {
+            if (!pending.valid()) return;
+            auto start = chrono::high_resolution_clock::now();
+            pending.get();
+            wait_ms += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        };
+
+        future<void> pending_load = async(launch::async, load, size_t(0), ref(buffers[0]));
+        future<void> pending_store[3];
+        for (size_t i = 0; i < count; ++i)
+        {
+            panel& current = buffers[i % 3];
+            wait(pending_load);
+            if (i + 1 < count)
+            {
+                // The next buffer was last used by panel i - 2, whose write must finish first
+                panel& next = buffers[(i + 1) % 3];
+                wait(pending_store[(i + 1) % 3]);
+                pending_load = async(launch::async, load, i + 1, ref(next));
+            }
+            compute(i, current);
+            pending_store[i % 3] = async(launch::async, store, i, cref(current));
+        }
+        for (future<void>& pending : pending_store)
+        {
+            wait(pending);
+        }
+        return wait_ms;
+    }
+}
+
+out_of_core_fft::out_of_core_fft(size_t size, size_t memory_budget_bytes, fft_direction direction)
+    : n(size), n1(1), n2(size), columns_per_panel(0), rows_per_panel(0), dir(direction), lo_bits(0), lo_mask(0)
+{
+    if (n < 4 || (n & (n - 1)) != 0)
+    {
+        throw invalid_argument("out_of_core_fft: size must be a power of two >= 4");
+    }
+    unsigned int log_n = 0;
+    while ((size_t(1) << log_n) < n) ++log_n;
+
+    n1 = size_t(1) << (log_n / 2);
+    n2 = n / n1;
+    lo_bits = (log_n + 1) / 2;
+    lo_mask = (size_t(1) << lo_bits) - 1;
+
+    // 1. Split the budget: twiddle tables first, the rest into four equal panels
+    const size_t table_bytes = ((size_t(1) << lo_bits) + (n >> lo_bits)) * sizeof(complex<double>);
+    const size_t panel_elements = memory_budget_bytes > table_bytes
+                                      ? (memory_budget_bytes - table_bytes) / 4 / sizeof(complex<double>)
+                                      : 0;
+    columns_per_panel = std::min(n1, floor_power_of_two(panel_elements / n2));
+    rows_per_panel = std::min(n2, floor_power_of_two(panel_elements / n1));
+    if (columns_per_panel == 0 || rows_per_panel == 0)
+    {
+        const size_t needed_mb = (table_bytes + 4 * n2 * sizeof(complex<double>) + (1 << 20) - 1) >> 20;
+        throw invalid_argument("out_of_core_fft: memory budget is too small for size " + to_string(n) +
+                               " (needs at least " + to_string(needed_mb) + " MB)");
+    }
+
+    // 2. Plans and the two-level twiddle tables for W_N^e
+    column_plan = fft_plan::get(n2, direction);
+    row_plan = fft_plan::get(n1, direction);
+    const double sign = (direction == fft_direction::forward) ? -1.0 : 1.0;
+    twiddle_lo.resize(size_t(1) << lo_bits);
+    twiddle_hi.resize(n >> lo_bits);
+    for (size_t e = 0; e < twiddle_lo.size(); ++e)
+    {
+        twiddle_lo[e] = polar(1.0, sign * 2 * M_PI * double(e) / double(n));
+    }
+    for (size_t e = 0; e < twiddle_hi.size(); ++e)
+    {
+        twiddle_hi[e] = polar(1.0, sign * 2 * M_PI * double(e << lo_bits) / double(n));
+    }
+}
+
+out_of_core_stats out_of_core_fft::execute(const string& input_path, const string& output_path,
+                                           thread_pool* pool) const
+{
+    const signal_file_header input_header = mapped_signal(input_path, 0).header();
+    if (input_header.layout != signal_layout::complex || input_header.element_type != signal_element_type::float64)
+    {
+        throw invalid_argument("out_of_core_fft: " + input_path + " must hold complex double samples");
+    }
+    if (input_header.sample_count < n)
+    {
+        throw invalid_argument("out_of_core_fft: " + input_path + " holds fewer than " + to_string(n) + " samples");
+    }
+
+    constexpr size_t element_bytes = sizeof(complex<double>);
+    const string temp_path = output_path + ".tmp";
+    const signal_file_header output_header =
+        signal_file::make_header(n, signal_element_type::float64, signal_layout::complex);
+
+    auto for_each_transform = [&](size_t count, const function<void(size_t, size_t)>& body)
+    {
+        if (pool == nullptr)
+        {
+            body(0, count);
+            return;
+        }
+        pool->parallel_for(count, std::max<size_t>(MIN_TRANSFORMS_PER_TASK, count / (size_t(pool->size()) * 4)), body);
+    };
+
+    out_of_core_stats stats;
+    panel buffers[3];
+    panel scratch;
+    const size_t P = columns_per_panel;
+    const size_t R = rows_per_panel;
+
+    {
+        // Pass 1: column FFTs and twiddles, input -> temporary file (same n2 x n1 layout)
+        scoped_file input(input_path, O_RDONLY);
+        scoped_file temp(temp_path, O_RDWR | O_CREAT | O_TRUNC);
+        posix_fadvise(input.fd, 0, 0, POSIX_FADV_DONTNEED);
+        for (panel& buffer : buffers) buffer.resize(n2 * P);
+        scratch.resize(n2 * P);
+
+        auto load = [&](size_t p, panel& buffer)
+        {
+            for (size_t j2 = 0; j2 < n2; ++j2)
+            {
+                read_exact(input.fd, buffer.data() + j2 * P, P * element_bytes,
+                           input_header.data_offset + (j2 * n1 + p * P) * element_bytes);
+            }
+        };
+        auto compute = [&](size_t p, panel& buffer)
+        {
+            four_step_fft::transpose(buffer.data(), scratch.data(), n2, P);
+            for_each_transform(P, [&](size_t begin, size_t end)
+            {
+                for (size_t c = begin; c < end; ++c)
+                {
+                    span<complex<double>> column(scratch.data() + c * n2, n2);
+                    benchmark::fft_radix4(column, *column_plan);
+                    const size_t j1 = p * P + c;
+                    for (size_t k2 = 1; k2 < n2; ++k2)
+                    {
+                        column[k2] *= twiddle(j1 * k2);
+                    }
+                }
+            });
+            four_step_fft::transpose(scratch.data(), buffer.data(), P, n2);
+        };
+        auto store = [&](size_t p, const panel& buffer)
+        {
+            for (size_t k2 = 0; k2 < n2; ++k2)
+            {
+                write_exact(temp.fd, buffer.data() + k2 * P, P * element_bytes, (k2 * n1 + p * P) * element_bytes);
+            }
+        };
+        stats.io_wait_ms += run_pipeline(n1 / P, buffers, load, compute, store);
+    }
+
+    {
+        // Pass 2: row FFTs, temporary file -> output, each panel written transposed
+        scoped_file temp(temp_path, O_RDONLY);
+        scoped_file output(output_path, O_RDWR | O_CREAT | O_TRUNC);
+        write_exact(output.fd, &output_header, sizeof(output_header), 0);
+        for (panel& buffer : buffers) buffer.resize(R * n1);
+        scratch.resize(R * n1);
+
+        auto load = [&](size_t p, panel& buffer)
+        {
+            read_exact(temp.fd, buffer.data(), R * n1 * element_bytes, p * R * n1 * element_bytes);
+        };
+        auto compute = [&](size_t, panel& buffer)
+        {
+            for_each_transform(R, [&](size_t begin, size_t end)
+            {
+                for (size_t r = begin; r < end; ++r)
+                {
+                    benchmark::fft_radix4(span<complex<double>>(buffer.data() + r * n1, n1), *row_plan);
+                }
+            });
+            // Row k2 = p * R + r, column k1 becomes X[k2 + n2 * k1]; the transposed panel is
+            // swapped in so the scratch buffer is free again for the next panel
+            four_step_fft::transpose(buffer.data(), scratch.data(), R, n1);
+            buffer.swap(scratch);
+        };
+        auto store = [&](size_t p, const panel& buffer)
+        {
+            for (size_t k1 = 0; k1 < n1; ++k1)
+            {
+                write_exact(output.fd, buffer.data() + k1 * R, R * element_bytes,
+                            output_header.data_offset + (k1 * n2 + p * R) * element_bytes);
+            }
+        };
+        stats.io_wait_ms += run_pipeline(n2 / R, buffers, load, compute, store);
+        fdatasync(output.fd);
+    }
+
+    unlink(temp_path.c_str());
+    stats.bytes_read = 2 * uint64_t(n) * element_bytes;
+    stats.bytes_written = 2 * uint64_t(n) * element_bytes;
+    return stats;
+}
+
+disk_throughput out_of_core_fft::measure_disk_throughput(const string& scratch_path, size_t bytes,
+                                                         size_t block_bytes)
+{
+    block_bytes = std::max<size_t>(std::min(block_bytes, bytes), 1);
+    vector<char> block(block_bytes, 1);
+    disk_throughput throughput;
+    {
+        scoped_file file(scratch_path, O_RDWR | O_CREAT | O_TRUNC);
+
+        auto start = chrono::high_resolution_clock::now();
+        for (size_t offset = 0; offset < bytes; offset += block_bytes)
+        {
+            write_exact(file.fd, block.data(), std::min(block_bytes, bytes - offset), offset);
+        }
+        fdatasync(file.fd);
+        chrono::duration<double> write_time = chrono::high_resolution_clock::now() - start;
+
+        posix_fadvise(file.fd, 0, 0, POSIX_FADV_DONTNEED);
+        start = chrono::high_resolution_clock::now();
+        for (size_t offset = 0; offset < bytes; offset += block_bytes)
+        {
+            read_exact(file.fd, block.data(), std::min(block_bytes, bytes - offset), offset);
+        }
+        chrono::duration<double> read_time = chrono::high_resolution_clock::now() - start;
+
+        throughput.write_mb_per_s = double(bytes) / 1e6 / write_time.count();
+        throughput.read_mb_per_s = double(bytes) / 1e6 / read_time.count();
+    }
+    unlink(scratch_path.c_str());
+    return throughput;
+}
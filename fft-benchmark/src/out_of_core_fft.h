@@ -0,0 +1,71 @@
+#pragma once
+
+#include "fft_plan.h"
+#include "thread_pool.h"
+
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct out_of_core_stats
+{
+    double io_wait_ms = 0.0;    // time the compute thread spent waiting for a panel read or write
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+};
+
+struct disk_throughput
+{
+    double read_mb_per_s = 0.0;
+    double write_mb_per_s = 0.0;
+};
+
+// Four-step FFT of a signal file that does not fit in memory, written to a second file.
+// With N = n1 * n2 the input is an n2 x n1 row-major matrix on disk.
+// Pass 1 reads panels of consecutive columns (one contiguous run per row), runs the
+// length-n2 column FFTs with their twiddles and writes the panel back to a temporary file
+// in the same layout. Pass 2 reads panels of consecutive rows of that file, runs the
+// length-n1 row FFTs and writes each panel transposed, so the output is in natural order.
+// Panels rotate through three buffers: while one is transformed, the next is being read
+// and the previous one written on background threads. Four panel buffers (the fourth is
+// the transpose scratch) plus the twiddle tables make up the memory budget.
+class out_of_core_fft {
+public:
+    out_of_core_fft(size_t size, size_t memory_budget_bytes, fft_direction direction = fft_direction::forward);
+
+    // input_path must be a complex double signal file of size() samples; output_path receives
+    // a signal file of the spectrum. The intermediate matrix lives in output_path + ".tmp".
+    // Page-cache contents of the input are dropped first, so reads come from the disk.
+    out_of_core_stats execute(const string& input_path, const string& output_path,
+                              thread_pool* pool = nullptr) const;
+
+    size_t size() const { return n; }
+    size_t rows() const { return n2; }
+    size_t cols() const { return n1; }
+    size_t panel_columns() const { return columns_per_panel; }
+    size_t panel_rows() const { return rows_per_panel; }
+
+    // Sequential write (with fsync) then read (with the cache dropped) of `bytes` in
+    // `block_bytes` requests through a scratch file, which is removed afterwards
+    static disk_throughput measure_disk_throughput(const string& scratch_path, size_t bytes, size_t block_bytes);
+
+private:
+    complex<double> twiddle(size_t e) const { return twiddle_hi[e >> lo_bits] * twiddle_lo[e & lo_mask]; }
+
+    size_t n;
+    size_t n1;
+    size_t n2;
+    size_t columns_per_panel;
+    size_t rows_per_panel;
+    fft_direction dir;
+    unsigned int lo_bits;
+    size_t lo_mask;
+    shared_ptr<const fft_plan> column_plan; // length n2
+    shared_ptr<const fft_plan> row_plan;    // length n1
+    vector<complex<double>> twiddle_lo;
+    vector<complex<double>> twiddle_hi;
+};
@@ -0,0 +1,282 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    perf_event_attr make_attr(perf_event event)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        auto cache_miss = [](uint64_t cache) { return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16); };
+        switch (event)
+        {
+        case perf_event::cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case perf_event::instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case perf_event::llc_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_miss(PERF_COUNT_HW_CACHE_LL);
+            break;
+        case perf_event::dtlb_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_miss(PERF_COUNT_HW_CACHE_DTLB);
+            break;
+        case perf_event::branch_misses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        }
+        return attr;
+    }
+
+    int open_counter(perf_event_attr& attr, pid_t tid, int group_fd)
+    {
+        return int(syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    string paranoid_level()
+    {
+        ifstream file("/proc/sys/kernel/perf_event_paranoid");
+        string level;
+        return (file >> level) ? level : "unknown";
+    }
+}
+
+perf_values& perf_values::operator+=(const perf_values& other)
+{
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+    {
+        counts[i] += other.counts[i];
+    }
+    return *this;
+}
+
+perf_counters::perf_counters()
+{
+    // 1. Every thread of the process at this point
+    vector<pid_t> tids;
+    error_code ec;
+    for (const auto& entry : filesystem::directory_iterator("/proc/self/task", ec))
+    {
+        tids.push_back(pid_t(stol(entry.path().filename().string())));
+    }
+    if (tids.empty())
+    {
+        tids.push_back(pid_t(syscall(SYS_gettid)));
+    }
+
+    // 2. One group per thread; an event that fails on the first thread is left out everywhere,
+    // so every group reports the same events
+    int first_error = 0;
+    array<bool, PERF_EVENT_COUNT> skipped{};
+    for (pid_t tid : tids)
+    {
+        counter_group group;
+        group.tid = tid;
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+        {
+            if (skipped[e]) continue;
+            perf_event_attr attr = make_attr(perf_event(e));
+            attr.disabled = group.leader_fd < 0 ? 1 : 0;
+            const int fd = open_counter(attr, tid, group.leader_fd);
+            if (fd < 0)
+            {
+                if (first_error == 0) first_error = errno;
+                if (groups.empty()) skipped[e] = true;
+                continue;
+            }
+            if (group.leader_fd < 0) group.leader_fd = fd;
+            group.fds.push_back(fd);
+            group.events.push_back(perf_event(e));
+        }
+        if (group.leader_fd < 0)
+        {
+            // A thread that exited since the directory was listed, or no events at all
+            continue;
+        }
+        ioctl(group.leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group.leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        groups.push_back(move(group));
+    }
+
+    for (const counter_group& group : groups)
+    {
+        for (perf_event event : group.events)
+        {
+            opened[size_t(event)] = true;
+        }
+    }
+    if (groups.empty())
+    {
+        status_message = string("perf_event_open failed: ") + strerror(first_error) +
+                         " (kernel.perf_event_paranoid = " + paranoid_level() + ")";
+    }
+    else
+    {
+        status_message = "counting on " + to_string(groups.size()) + " threads";
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+        {
+            if (!opened[e]) status_message += string(", ") + event_name(perf_event(e)) + " unavailable";
+        }
+    }
+}
+
+perf_counters::~perf_counters()
+{
+    for (const counter_group& group : groups)
+    {
+        for (int fd : group.fds)
+        {
+            close(fd);
+        }
+    }
+}
+
+bool perf_counters::read_group(size_t index, perf_snapshot::group_reading& reading) const
+{
+    const counter_group& group = groups[index];
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+    uint64_t buffer[3 + PERF_EVENT_COUNT];
+    const ssize_t got = ::read(group.leader_fd, buffer, sizeof(buffer));
+    if (got < ssize_t(3 * sizeof(uint64_t)) || buffer[0] != group.events.size())
+    {
+        return false;
+    }
+    reading.group = index;
+    reading.time_enabled = buffer[1];
+    reading.time_running = buffer[2];
+    for (size_t i = 0; i < group.events.size(); ++i)
+    {
+        reading.values[size_t(group.events[i])] = buffer[3 + i];
+    }
+    return true;
+}
+
+perf_snapshot perf_counters::read() const
+{
+    perf_snapshot snapshot;
+    snapshot.groups.reserve(groups.size());
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        perf_snapshot::group_reading reading;
+        if (read_group(i, reading))
+        {
+            snapshot.groups.push_back(reading);
+        }
+    }
+    return snapshot;
+}
+
+perf_snapshot perf_counters::read_calling_thread() const
+{
+    perf_snapshot snapshot;
+    const pid_t tid = pid_t(syscall(SYS_gettid));
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        perf_snapshot::group_reading reading;
+        if (groups[i].tid == tid && read_group(i, reading))
+        {
+            snapshot.groups.push_back(reading);
+        }
+    }
+    return snapshot;
+}
+
+perf_values perf_counters::difference(const perf_snapshot& before, const perf_snapshot& after)
+{
+    perf_values result;
+    for (const perf_snapshot::group_reading& end : after.groups)
+    {
+        for (const perf_snapshot::group_reading& start : before.groups)
+        {
+            if (start.group != end.group) continue;
+
+            // While multiplexed, a group only counts for time_running of time_enabled
+            const uint64_t enabled = end.time_enabled - start.time_enabled;
+            const uint64_t running = end.time_running - start.time_running;
+            const double scale = (running > 0 && running < enabled) ? double(enabled) / double(running) : 1.0;
+            for (size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+            {
+                result.counts[e] += double(end.values[e] - start.values[e]) * scale;
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+const char* perf_counters::event_name(perf_event event)
+{
+    switch (event)
+    {
+    case perf_event::cycles: return "Cycles";
+    case perf_event::instructions: return "Instructions";
+    case perf_event::llc_misses: return "LLC_Misses";
+    case perf_event::dtlb_misses: return "DTLB_Misses";
+    default: return "Branch_Misses";
+    }
+}
+
+void phase_profiler::begin_phase(fft_phase phase, unsigned int stage)
+{
+    open_phase current{phase, stage, {}, {}};
+    current.start = phase == fft_phase::barrier ? counters.read_calling_thread() : counters.read();
+    current.start_time = chrono::high_resolution_clock::now();
+    open_phases.push_back(move(current));
+}
+
+void phase_profiler::end_phase()
+{
+    if (open_phases.empty()) return;
+    const auto end_time = chrono::high_resolution_clock::now();
+    const open_phase& current = open_phases.back();
+    const perf_snapshot end = current.phase == fft_phase::barrier ? counters.read_calling_thread() : counters.read();
+
+    phase_record record;
+    record.phase = current.phase;
+    record.stage = current.stage;
+    record.time_ms = chrono::duration<double, milli>(end_time - current.start_time).count();
+    record.counters = perf_counters::difference(current.start, end);
+    phase_records.push_back(record);
+    open_phases.pop_back();
+}
+
+perf_values phase_profiler::total(fft_phase phase) const
+{
+    perf_values sum;
+    for (const phase_record& record : phase_records)
+    {
+        if (record.phase == phase) sum += record.counters;
+    }
+    return sum;
+}
+
+const char* phase_profiler::phase_name(fft_phase phase)
+{
+    switch (phase)
+    {
+    case fft_phase::permute: return "permute";
+    case fft_phase::butterfly: return "butterfly";
+    default: return "barrier";
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+using namespace std;
+
+// Hardware events sampled per phase, in CSV column order
+enum class perf_event
+{
+    cycles,
+    instructions,
+    llc_misses,   // last-level cache read misses
+    dtlb_misses,  // data TLB read misses
+    branch_misses
+};
+
+constexpr size_t PERF_EVENT_COUNT = 5;
+
+// Event counts over some interval, scaled up when the kernel multiplexed the counters
+struct perf_values
+{
+    array<double, PERF_EVENT_COUNT> counts{};
+
+    double& operator[](perf_event event) { return counts[size_t(event)]; }
+    double operator[](perf_event event) const { return counts[size_t(event)]; }
+    perf_values& operator+=(const perf_values& other);
+};
+
+// Raw readings of every counter group at one instant
+struct perf_snapshot
+{
+    struct group_reading
+    {
+        size_t group = 0;
+        uint64_t time_enabled = 0;
+        uint64_t time_running = 0;
+        array<uint64_t, PERF_EVENT_COUNT> values{};
+    };
+    vector<group_reading> groups;
+};
+
+// In-process hardware counters through perf_event_open. One counter group (led by the
+// first event that opens) is attached to every thread the process has at construction,
+// so create it after the thread pool; user-space only, which perf_event_paranoid <= 2
+// allows for the process's own threads. Events the CPU, hypervisor or kernel refuse are
+// left out, and when none open available() is false and status() says why.
+class perf_counters {
+public:
+    perf_counters();
+    ~perf_counters();
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    bool available() const { return !groups.empty(); }
+    bool has_event(perf_event event) const { return opened[size_t(event)]; }
+    const string& status() const { return status_message; }
+    size_t thread_count() const { return groups.size(); }
+
+    // Every thread's group, or only the calling thread's
+    perf_snapshot read() const;
+    perf_snapshot read_calling_thread() const;
+
+    // Counts between two snapshots, summed over the groups present in both
+    static perf_values difference(const perf_snapshot& before, const perf_snapshot& after);
+
+    // CSV column name of an event, e.g. "LLC_Misses"
+    static const char* event_name(perf_event event);
+
+private:
+    struct counter_group
+    {
+        pid_t tid = 0;
+        int leader_fd = -1;
+        vector<int> fds;
+        vector<perf_event> events; // in the order the group reports them
+    };
+
+    bool read_group(size_t index, perf_snapshot::group_reading& reading) const;
+
+    vector<counter_group> groups;
+    array<bool, PERF_EVENT_COUNT> opened{};
+    string status_message;
+};
+
+// Phases an instrumented kernel reports
+enum class fft_phase
+{
+    permute,   // bit-reversal
+    butterfly, // one butterfly stage, numbered from the first (shortest) span
+    barrier    // the calling thread waiting for the pool to finish a stage
+};
+
+// Receives phase boundaries from the kernels; phases may nest (a barrier inside a stage)
+class fft_phase_observer {
+public:
+    virtual ~fft_phase_observer() = default;
+    virtual void begin_phase(fft_phase phase, unsigned int stage) = 0;
+    virtual void end_phase() = 0;
+};
+
+// Records counter deltas and wall time per phase. Permutation and butterfly phases count
+// every thread, since the whole pool works on them; barrier phases count only the waiting
+// calling thread, which is the cost of the join itself.
+class phase_profiler : public fft_phase_observer {
+public:
+    struct phase_record
+    {
+        fft_phase phase;
+        unsigned int stage;
+        double time_ms;
+        perf_values counters;
+    };
+
+    explicit phase_profiler(const perf_counters& perf) : counters(perf) {}
+
+    void begin_phase(fft_phase phase, unsigned int stage) override;
+    void end_phase() override;
+
+    void clear() { phase_records.clear(); }
+    const vector<phase_record>& records() const { return phase_records; }
+    // Sum over every record of one phase kind
+    perf_values total(fft_phase phase) const;
+
+    static const char* phase_name(fft_phase phase);
+
+private:
+    struct open_phase
+    {
+        fft_phase phase;
+        unsigned int stage;
+        chrono::high_resolution_clock::time_point start_time;
+        perf_snapshot start;
+    };
+
+    const perf_counters& counters;
+    vector<open_phase> open_phases;
+    vector<phase_record> phase_records;
+};
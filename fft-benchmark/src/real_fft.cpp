@@ -0,0 +1,98 @@
+#include "real_fft.h"
+
+#include "benchmark.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+real_fft::real_fft(size_t size)
+    : n(size)
+{
+    if (n < 2 || (n & (n - 1)) != 0)
+    {
+        throw invalid_argument("real_fft: size must be a power of two >= 2");
+    }
+    half_forward = fft_plan::get(n / 2, fft_direction::forward);
+
+    twiddles.resize(n / 2);
+    for (size_t k = 0; k < n / 2; ++k)
+    {
+        twiddles[k] = polar(1.0, -2 * M_PI * double(k) / double(n));
+    }
+}
+
+void real_fft::forward(span<const double> input, span<complex<double>> output) const
+{
+    const size_t M = n / 2;
+    if (input.size() != n || output.size() < M + 1)
+    {
+        throw invalid_argument("real_fft::forward: buffer sizes do not match the plan");
+    }
+
+    // 1. Pack pairs of reals into the output as complex values and transform them there
+    for (size_t j = 0; j < M; ++j)
+    {
+        output[j] = {input[2 * j], input[2 * j + 1]};
+    }
+    benchmark::fft_radix4(output.first(M), *half_forward);
+
+    // 2. Split Z into the spectra of the even (E) and odd (O) samples and recombine:
+    //    X_k = E_k + W^k O_k,  X_(M-k) = conj(E_k - W^k O_k)
+    const complex<double> z0 = output[0];
+    output[0] = {z0.real() + z0.imag(), 0.0};
+    output[M] = {z0.real() - z0.imag(), 0.0};
+    for (size_t k = 1; k <= M / 2; ++k)
+    {
+        const complex<double> zk = output[k];
+        const complex<double> zm = conj(output[M - k]);
+        const complex<double> even = 0.5 * (zk + zm);
+        const complex<double> odd = complex<double>(0.0, -0.5) * (zk - zm);
+        const complex<double> w_odd = twiddles[k] * odd;
+        output[k] = even + w_odd;
+        output[M - k] = conj(even - w_odd);
+    }
+}
+
+void real_fft::inverse(span<const complex<double>> input, span<double> output) const
+{
+    const size_t M = n / 2;
+    if (input.size() < M + 1 || output.size() != n)
+    {
+        throw invalid_argument("real_fft::inverse: buffer sizes do not match the plan");
+    }
+
+    // The output holds exactly M complex values, so Z is assembled and transformed in place
+    span<complex<double>> z(reinterpret_cast<complex<double>*>(output.data()), M);
+
+    // Z_k = E_k + i O_k with E_k = X_k + conj(X_(M-k)) and O_k = (X_k - conj(X_(M-k))) conj(W^k);
+    // dropping the factor 1/2 keeps the result scaled by N like the other inverse transforms
+    for (size_t k = 0; k <= M / 2; ++k)
+    {
+        const complex<double> xk = input[k];
+        const complex<double> xm = conj(input[M - k]);
+        const complex<double> even = xk + xm;
+        const complex<double> odd = (xk - xm) * conj(twiddles[k]);
+        z[k] = even + complex<double>(0.0, 1.0) * odd;
+        if (k != 0 && k != M - k)
+        {
+            z[M - k] = conj(even) + complex<double>(0.0, 1.0) * conj(odd);
+        }
+    }
+
+    benchmark::fft_inverse(z, *half_forward, false);
+}
+
+shared_ptr<const real_fft> real_fft::get(size_t size)
+{
+    static mutex cache_mutex;
+    static map<size_t, shared_ptr<const real_fft>> cache;
+    lock_guard<mutex> lock(cache_mutex);
+    auto& plan = cache[size];
+    if (!plan)
+    {
+        plan = make_shared<const real_fft>(size);
+    }
+    return plan;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "fft_plan.h"
+
+#include <complex>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+// Transforms of real signals via a complex FFT of half the length.
+// forward (r2c): N reals are read as N/2 complex values z[n] = x[2n] + i*x[2n+1],
+// transformed, and split back into the even/odd spectra by one twiddle pass,
+// giving the N/2 + 1 non-redundant bins of the Hermitian spectrum.
+// inverse (c2r) undoes this through the same forward plan and, like the inverse plans,
+// is unnormalized: inverse(forward(x)) == N * x.
+class real_fft {
+public:
+    explicit real_fft(size_t size);
+
+    size_t size() const { return n; }
+    size_t spectrum_size() const { return n / 2 + 1; }
+
+    // output must hold N/2 + 1 bins
+    void forward(span<const double> input, span<complex<double>> output) const;
+    // input holds N/2 + 1 bins; output receives N reals
+    void inverse(span<const complex<double>> input, span<double> output) const;
+
+    static shared_ptr<const real_fft> get(size_t size);
+
+private:
+    size_t n;
+    shared_ptr<const fft_plan> half_forward;
+    vector<complex<double>> twiddles; // W_N^k, k < N/2
+};
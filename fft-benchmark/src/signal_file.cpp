@@ -0,0 +1,158 @@
+#include "signal_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr char MAGIC[8] = {'F', 'F', 'T', 'S', 'I', 'G', 'N', 'L'};
+
+    template <typename E>
+    void convert_samples(const void* data, signal_layout layout, span<complex<double>> output)
+    {
+        const E* values = static_cast<const E*>(data);
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+            output[i] = layout == signal_layout::complex ? complex<double>(values[2 * i], values[2 * i + 1])
+                                                         : complex<double>(values[i], 0.0);
+        }
+    }
+}
+
+signal_file_header signal_file::make_header(uint64_t sample_count, signal_element_type element_type,
+                                            signal_layout layout)
+{
+    signal_file_header header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.element_type = element_type;
+    header.layout = layout;
+    header.alignment = DATA_ALIGNMENT;
+    header.sample_count = sample_count;
+    header.data_offset = (sizeof(signal_file_header) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    return header;
+}
+
+void signal_file::write_header(ostream& out, const signal_file_header& header)
+{
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (uint64_t i = sizeof(header); i < header.data_offset; ++i)
+    {
+        out.put('\0');
+    }
+}
+
+size_t signal_file::element_bytes(signal_element_type element_type)
+{
+    return element_type == signal_element_type::float32 ? sizeof(float) : sizeof(double);
+}
+
+size_t signal_file::sample_bytes(const signal_file_header& header)
+{
+    return element_bytes(header.element_type) * (header.layout == signal_layout::complex ? 2 : 1);
+}
+
+mapped_signal::mapped_signal(const string& path, uint64_t max_samples)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("mapped_signal: cannot open " + path + ": " + strerror(errno));
+    }
+
+    // 1. Validate the header against the file size
+    struct stat file_stat{};
+    const bool header_read = fstat(fd, &file_stat) == 0 && size_t(file_stat.st_size) >= sizeof(file_header) &&
+                             pread(fd, &file_header, sizeof(file_header), 0) == ssize_t(sizeof(file_header));
+    string error;
+    if (!header_read || memcmp(file_header.magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = "not a binary signal file (regenerate it with generate_input --format binary)";
+    }
+    else if (file_header.version != signal_file::VERSION)
+    {
+        error = "unsupported version " + to_string(file_header.version);
+    }
+    else if ((file_header.element_type != signal_element_type::float32 &&
+              file_header.element_type != signal_element_type::float64) ||
+             (file_header.layout != signal_layout::real && file_header.layout != signal_layout::complex))
+    {
+        error = "unknown element type or layout";
+    }
+    else if (file_header.alignment == 0 || file_header.data_offset % file_header.alignment != 0 ||
+             file_header.data_offset < sizeof(file_header))
+    {
+        error = "misaligned sample data";
+    }
+    else if (uint64_t(file_stat.st_size) <
+             file_header.data_offset + file_header.sample_count * signal_file::sample_bytes(file_header))
+    {
+        error = "file is shorter than its header claims";
+    }
+    if (!error.empty())
+    {
+        close(fd);
+        throw runtime_error("mapped_signal: " + path + ": " + error);
+    }
+
+    // 2. Map the header and the requested prefix read-only
+    samples = size_t(std::min(file_header.sample_count, max_samples));
+    mapped_bytes = size_t(file_header.data_offset) + samples * signal_file::sample_bytes(file_header);
+    base = mmap(nullptr, mapped_bytes, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    const int map_errno = errno;
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        base = nullptr;
+        throw runtime_error("mapped_signal: cannot map " + path + ": " + strerror(map_errno));
+    }
+    madvise(base, mapped_bytes, MADV_SEQUENTIAL);
+}
+
+mapped_signal::~mapped_signal()
+{
+    if (base != nullptr)
+    {
+        munmap(base, mapped_bytes);
+    }
+}
+
+template <typename T>
+span<const complex<T>> mapped_signal::complex_samples() const
+{
+    const signal_element_type wanted = is_same_v<T, float> ? signal_element_type::float32
+                                                           : signal_element_type::float64;
+    if (file_header.layout != signal_layout::complex || file_header.element_type != wanted)
+    {
+        return {};
+    }
+    return {reinterpret_cast<const complex<T>*>(static_cast<const char*>(base) + file_header.data_offset), samples};
+}
+
+template span<const complex<float>> mapped_signal::complex_samples<float>() const;
+template span<const complex<double>> mapped_signal::complex_samples<double>() const;
+
+void mapped_signal::copy_to(span<complex<double>> output) const
+{
+    if (output.size() > samples)
+    {
+        throw invalid_argument("mapped_signal::copy_to: more samples requested than mapped");
+    }
+    const void* data = static_cast<const char*>(base) + file_header.data_offset;
+    if (file_header.element_type == signal_element_type::float32)
+    {
+        convert_samples<float>(data, file_header.layout, output);
+    }
+    else
+    {
+        convert_samples<double>(data, file_header.layout, output);
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+
+using namespace std;
+
+enum class signal_element_type : uint32_t
+{
+    float32 = 1,
+    float64 = 2
+};
+
+enum class signal_layout : uint32_t
+{
+    real = 1,
+    complex = 2 // interleaved (re, im) pairs
+};
+
+// Binary signal file: this 64-byte header, then sample_count samples starting at
+// data_offset, which is a multiple of `alignment` (and so of the page-aligned mapping).
+// All fields are little-endian, as written by generate_input --format binary.
+struct signal_file_header
+{
+    char magic[8];               // "FFTSIGNL"
+    uint32_t version;
+    signal_element_type element_type;
+    signal_layout layout;
+    uint32_t alignment;
+    uint64_t sample_count;
+    uint64_t data_offset;
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(signal_file_header) == 64, "signal_file_header must stay 64 bytes");
+
+class signal_file {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t DATA_ALIGNMENT = 64;
+
+    static signal_file_header make_header(uint64_t sample_count, signal_element_type element_type,
+                                          signal_layout layout);
+    // Header plus the zero padding up to data_offset; the samples follow directly
+    static void write_header(ostream& out, const signal_file_header& header);
+
+    static size_t element_bytes(signal_element_type element_type);
+    // Bytes per sample: one element for real signals, two for complex ones
+    static size_t sample_bytes(const signal_file_header& header);
+};
+
+// Read-only view of a signal file mapped with mmap: nothing is parsed or copied in user
+// space, and complex samples of the right type are read straight from the file's pages.
+// Only the header and the first `max_samples` samples are mapped.
+class mapped_signal {
+public:
+    explicit mapped_signal(const string& path, uint64_t max_samples = UINT64_MAX);
+    ~mapped_signal();
+
+    mapped_signal(const mapped_signal&) = delete;
+    mapped_signal& operator=(const mapped_signal&) = delete;
+
+    const signal_file_header& header() const { return file_header; }
+    // Samples covered by the mapping
+    size_t size() const { return samples; }
+
+    // The mapped samples as complex<T>, or an empty span when the file is not complex T
+    template <typename T>
+    span<const complex<T>> complex_samples() const;
+
+    // Converts the first output.size() samples of any element type and layout
+    void copy_to(span<complex<double>> output) const;
+
+private:
+    signal_file_header file_header;
+    void* base = nullptr;
+    size_t mapped_bytes = 0;
+    size_t samples = 0;
+};
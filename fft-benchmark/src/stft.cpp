@@ -0,0 +1,283 @@
+#include "stft.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace
+{
+    const stft_options& checked(const stft_options& options)
+    {
+        const size_t n = options.window_size;
+        if (n < 2 || (n & (n - 1)) != 0)
+        {
+            throw invalid_argument("streaming_stft: window_size must be a power of two >= 2");
+        }
+        if (options.hop == 0 || options.hop > n)
+        {
+            throw invalid_argument("streaming_stft: hop must be in [1, window_size]");
+        }
+        if (options.batch_frames == 0 || options.ring_frames < options.batch_frames)
+        {
+            throw invalid_argument("streaming_stft: need 1 <= batch_frames <= ring_frames");
+        }
+        return options;
+    }
+}
+
+streaming_stft::streaming_stft(const stft_options& options, simd_isa isa, thread_pool* pool)
+    : settings(checked(options)),
+      engine(options.window_size, fft_direction::forward, isa),
+      workers(pool),
+      coefficients(make_window(options.window, options.window_size))
+{
+    work.resize((settings.batch_frames + 1) / 2 * settings.window_size);
+    slots.resize(settings.batch_frames);
+    ring.resize(settings.ring_frames * slot_width());
+    ring_index.resize(settings.ring_frames);
+    ring_latency.resize(settings.ring_frames);
+    history.reserve(settings.window_size + settings.batch_frames * settings.hop);
+    ready_at.reserve(settings.batch_frames);
+}
+
+void streaming_stft::reset()
+{
+    history.clear();
+    history_start = 0;
+    next_frame = 0;
+    ready_at.clear();
+    ring_head = 0;
+    ring_count = 0;
+    next_emitted = 0;
+    dropped = 0;
+}
+
+void streaming_stft::push(span<const double> samples)
+{
+    const clock::time_point arrival = clock::now();
+    const size_t n = settings.window_size;
+    const size_t hop = settings.hop;
+    history.insert(history.end(), samples.begin(), samples.end());
+
+    // 1. Frames whose last sample is now in: frame k is ready once k * hop + N samples arrived
+    const uint64_t total = history_start + history.size();
+    const uint64_t ready_end = total >= n ? (total - n) / hop + 1 : 0;
+    for (uint64_t frame = next_frame + ready_at.size(); frame < ready_end; ++frame)
+    {
+        ready_at.push_back(arrival);
+    }
+
+    // 2. Every full batch
+    while (ready_at.size() >= settings.batch_frames)
+    {
+        transform_ready(settings.batch_frames);
+    }
+
+    // 3. Keep only what the next untransformed frame needs
+    const uint64_t keep_from = std::min<uint64_t>(next_frame * hop, total);
+    if (keep_from > history_start)
+    {
+        history.erase(history.begin(), history.begin() + (keep_from - history_start));
+        history_start = keep_from;
+    }
+}
+
+void streaming_stft::flush()
+{
+    if (!ready_at.empty())
+    {
+        transform_ready(ready_at.size());
+    }
+}
+
+void streaming_stft::transform_ready(size_t count)
+{
+    // 1. A ring slot per frame, oldest frames first to go; count <= ring_frames, so the
+    //    slots of one batch are distinct
+    const size_t capacity = settings.ring_frames;
+    for (size_t k = 0; k < count; ++k)
+    {
+        if (ring_count == capacity)
+        {
+            ring_head = (ring_head + 1) % capacity;
+            --ring_count;
+            ++dropped;
+        }
+        slots[k] = (ring_head + ring_count) % capacity;
+        ++ring_count;
+    }
+
+    // 2. Window, transform and unpack, lanes(isa) complex frames per task
+    const size_t pairs = (count + 1) / 2;
+    const size_t width = engine.lanes();
+    const size_t groups = (pairs + width - 1) / width;
+    auto body = [&](size_t begin, size_t end)
+    {
+        for (size_t group = begin; group < end; ++group)
+        {
+            const size_t first = group * width;
+            transform_pairs(first, std::min(width, pairs - first), count);
+        }
+    };
+    if (workers == nullptr || groups == 1)
+    {
+        body(0, groups);
+    }
+    else
+    {
+        workers->parallel_for(groups, 1, body);
+    }
+
+    // 3. Emission
+    const clock::time_point emitted = clock::now();
+    for (size_t k = 0; k < count; ++k)
+    {
+        ring_index[slots[k]] = next_frame + k;
+        ring_latency[slots[k]] = chrono::duration<double, milli>(emitted - ready_at[k]).count();
+    }
+    ready_at.erase(ready_at.begin(), ready_at.begin() + count);
+    next_frame += count;
+    next_emitted += count;
+}
+
+void streaming_stft::transform_pairs(size_t first_pair, size_t count, size_t frames)
+{
+    const size_t n = settings.window_size;
+    const size_t width = slot_width();
+    complex<double>* data = work.data() + first_pair * n;
+
+    // 1. Frames 2p and 2p + 1 of the batch become the real and imaginary parts of pair p
+    for (size_t p = 0; p < count; ++p)
+    {
+        const size_t frame = 2 * (first_pair + p);
+        const double* x = history.data() + ((next_frame + frame) * settings.hop - history_start);
+        complex<double>* out = data + p * n;
+        if (frame + 1 < frames)
+        {
+            const double* y = x + settings.hop;
+            for (size_t i = 0; i < n; ++i)
+            {
+                out[i] = {x[i] * coefficients[i], y[i] * coefficients[i]};
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                out[i] = {x[i] * coefficients[i], 0.0};
+            }
+        }
+    }
+
+    // 2. One batched call for the group
+    engine.execute(data, count, nullptr);
+
+    // 3. Split each pair into its frames' slots
+    for (size_t p = 0; p < count; ++p)
+    {
+        const size_t frame = 2 * (first_pair + p);
+        double* second = frame + 1 < frames ? ring.data() + slots[frame + 1] * width : nullptr;
+        unpack(data + p * n, ring.data() + slots[frame] * width, second);
+    }
+}
+
+void streaming_stft::unpack(const complex<double>* spectrum, double* first, double* second) const
+{
+    // Z = DFT(a + ib): A[k] = (Z[k] + conj(Z[N-k])) / 2 and B[k] = (Z[k] - conj(Z[N-k])) / 2i
+    const size_t n = settings.window_size;
+    const bool magnitude = settings.output == stft_output::magnitude;
+    for (size_t k = 0; k <= n / 2; ++k)
+    {
+        const complex<double> z = spectrum[k];
+        const complex<double> mirror = conj(spectrum[(n - k) & (n - 1)]);
+        const complex<double> a = 0.5 * (z + mirror);
+        const complex<double> d = 0.5 * (z - mirror);
+        const complex<double> b(d.imag(), -d.real());
+        if (magnitude)
+        {
+            first[k] = abs(a);
+            if (second) second[k] = abs(b);
+        }
+        else
+        {
+            first[2 * k] = a.real();
+            first[2 * k + 1] = a.imag();
+            if (second)
+            {
+                second[2 * k] = b.real();
+                second[2 * k + 1] = b.imag();
+            }
+        }
+    }
+}
+
+bool streaming_stft::pop(stft_frame& frame)
+{
+    if (ring_count == 0)
+    {
+        return false;
+    }
+    const size_t width = slot_width();
+    frame.index = ring_index[ring_head];
+    frame.latency_ms = ring_latency[ring_head];
+    frame.values = span<const double>(ring.data() + ring_head * width, width);
+    ring_head = (ring_head + 1) % settings.ring_frames;
+    --ring_count;
+    return true;
+}
+
+vector<double> streaming_stft::make_window(window_kind kind, size_t size)
+{
+    // Generalised cosine windows sum_j (-1)^j a_j cos(2 pi j i / N), periodic in N
+    vector<double> a;
+    switch (kind)
+    {
+    case window_kind::hann: a = {0.5, 0.5}; break;
+    case window_kind::hamming: a = {0.54, 0.46}; break;
+    case window_kind::blackman: a = {0.42, 0.5, 0.08}; break;
+    case window_kind::blackman_harris: a = {0.35875, 0.48829, 0.14128, 0.01168}; break;
+    default: a = {1.0}; break;
+    }
+
+    vector<double> window(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        const double t = 2.0 * numbers::pi * double(i) / double(size);
+        double value = 0.0;
+        for (size_t j = 0; j < a.size(); ++j)
+        {
+            value += (j % 2 == 0 ? a[j] : -a[j]) * cos(double(j) * t);
+        }
+        window[i] = value;
+    }
+    return window;
+}
+
+const char* streaming_stft::window_name(window_kind kind)
+{
+    switch (kind)
+    {
+    case window_kind::hann: return "hann";
+    case window_kind::hamming: return "hamming";
+    case window_kind::blackman: return "blackman";
+    case window_kind::blackman_harris: return "blackman-harris";
+    default: return "rectangular";
+    }
+}
+
+bool streaming_stft::parse_window(const string& name, window_kind& kind)
+{
+    for (window_kind candidate : {window_kind::rectangular, window_kind::hann, window_kind::hamming,
+                                  window_kind::blackman, window_kind::blackman_harris})
+    {
+        if (name == window_name(candidate))
+        {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
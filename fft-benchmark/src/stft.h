@@ -0,0 +1,120 @@
+#pragma once
+
+#include "batched_fft.h"
+#include "fft_simd.h"
+
+#include <chrono>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class thread_pool;
+
+// Periodic (DFT-even) windows, the usual choice for spectral analysis
+enum class window_kind
+{
+    rectangular,
+    hann,
+    hamming,
+    blackman,
+    blackman_harris // 4-term, -92 dB sidelobes
+};
+
+enum class stft_output
+{
+    magnitude, // N/2 + 1 magnitudes per frame
+    complex    // N/2 + 1 bins per frame, stored as interleaved re, im
+};
+
+struct stft_options
+{
+    size_t window_size = 2048; // power of two
+    size_t hop = 512;          // samples between frame starts, 1 <= hop <= window_size
+    window_kind window = window_kind::hann;
+    stft_output output = stft_output::magnitude;
+    // Ready frames are held back until this many can be transformed together; 1 emits every
+    // frame as soon as its last sample arrives
+    size_t batch_frames = 16;
+    // Emitted frames kept for the consumer; when it falls behind the oldest are overwritten
+    size_t ring_frames = 256;
+};
+
+// One emitted frame. values stays valid until the frame's ring slot is reused, i.e. at
+// least until the next push() or flush().
+struct stft_frame
+{
+    uint64_t index = 0;        // frame number; frame k covers samples [k * hop, k * hop + N)
+    double latency_ms = 0.0;   // from the push() that delivered its last sample to its emission
+    span<const double> values; // bins() magnitudes, or 2 * bins() interleaved re, im
+};
+
+// Short-time Fourier transform of an unbounded real stream. Samples arrive through push()
+// in chunks of any length and are kept only as long as a pending frame still needs them.
+// Ready frames are windowed straight from that history into a reused [pairs][N] buffer two
+// at a time, as the real and imaginary parts of one complex frame, transformed by the
+// lane-interleaved batched engine and split into their two Hermitian halves on the way out
+// to the ring. With a pool, groups of lanes(isa) complex frames are spread over the
+// participants, each windowing, transforming and unpacking its own group.
+class streaming_stft {
+public:
+    explicit streaming_stft(const stft_options& options, simd_isa isa = simd_fft::detect_isa(),
+                            thread_pool* pool = nullptr);
+
+    // Consumes the samples and transforms every full batch of ready frames
+    void push(span<const double> samples);
+    // Transforms the ready frames still waiting for a full batch; the stream continues
+    void flush();
+    // Drops all samples and frames and starts a new stream at frame 0
+    void reset();
+
+    // Oldest emitted frame not yet popped; false when the ring is empty
+    bool pop(stft_frame& frame);
+    size_t available() const { return ring_count; }
+    // Frames overwritten before the consumer popped them
+    uint64_t dropped_frames() const { return dropped; }
+    uint64_t emitted_frames() const { return next_emitted; }
+
+    size_t bins() const { return settings.window_size / 2 + 1; }
+    const stft_options& options() const { return settings; }
+    const vector<double>& window() const { return coefficients; }
+
+    static vector<double> make_window(window_kind kind, size_t size);
+    static const char* window_name(window_kind kind);
+    // Accepts rectangular|hann|hamming|blackman|blackman-harris; returns false for anything else
+    static bool parse_window(const string& name, window_kind& kind);
+
+private:
+    using clock = chrono::steady_clock;
+
+    void transform_ready(size_t count);
+    void transform_pairs(size_t first_pair, size_t count, size_t frames);
+    void unpack(const complex<double>* spectrum, double* first, double* second) const;
+    size_t slot_width() const { return settings.output == stft_output::magnitude ? bins() : 2 * bins(); }
+
+    stft_options settings;
+    batched_fft engine;
+    thread_pool* workers;
+    vector<double> coefficients;
+
+    // Input history: samples [history_start, history_start + history.size())
+    vector<double> history;
+    uint64_t history_start = 0;
+    uint64_t next_frame = 0;            // first frame not yet transformed
+    vector<clock::time_point> ready_at; // arrival time of each ready, untransformed frame
+
+    vector<complex<double>> work; // [pairs][N]
+    vector<size_t> slots;         // ring slot of each frame in the batch being transformed
+
+    vector<double> ring;              // ring_frames slots of slot_width() values
+    vector<uint64_t> ring_index;
+    vector<double> ring_latency;
+    size_t ring_head = 0;             // oldest slot
+    size_t ring_count = 0;
+    uint64_t next_emitted = 0;
+    uint64_t dropped = 0;
+};
@@ -0,0 +1,184 @@
+#include "thread_pool.h"
+
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    // Yields before a worker parks; covers the gap between two stages of one transform
+    constexpr unsigned int SPIN_ITERATIONS = 4096;
+
+    uint64_t pack(uint32_t lo, uint32_t hi) { return (uint64_t(lo) << 32) | hi; }
+    uint32_t range_lo(uint64_t bounds) { return uint32_t(bounds >> 32); }
+    uint32_t range_hi(uint64_t bounds) { return uint32_t(bounds); }
+}
+
+thread_pool::thread_pool(unsigned int num_threads, const vector<int>& cpus)
+    : num_participants(std::max(1u, num_threads)),
+      participant_cpus(cpus),
+      ranges(make_unique<chunk_range[]>(std::max(1u, num_threads)))
+{
+    if (!participant_cpus.empty())
+    {
+        cpu_topology::pin_current_thread(participant_cpus[0]);
+    }
+    for (unsigned int id = 1; id < num_participants; ++id)
+    {
+        workers.emplace_back(&thread_pool::worker_loop, this, id);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        stopping.store(true, memory_order_release);
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void thread_pool::parallel_for(size_t count, size_t grain, const function<void(size_t, size_t)>& body)
+{
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    const size_t num_chunks = (count + grain - 1) / grain;
+
+    if (num_participants == 1 || num_chunks == 1)
+    {
+        for (size_t begin = 0; begin < count; begin += grain)
+        {
+            body(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    job = &body;
+    job_count = count;
+    job_grain = grain;
+    for (unsigned int id = 0; id < num_participants; ++id)
+    {
+        const uint32_t lo = uint32_t(num_chunks * id / num_participants);
+        const uint32_t hi = uint32_t(num_chunks * (id + 1) / num_participants);
+        ranges[id].bounds.store(pack(lo, hi), memory_order_relaxed);
+    }
+    busy_workers.store(num_participants - 1, memory_order_relaxed);
+    ++dispatches;
+
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        generation.fetch_add(1, memory_order_release);
+    }
+    wake.notify_all();
+
+    run_chunks(0);
+
+    // Every chunk is owned by exactly one participant until it has run, so the job is
+    // finished once all workers have run out of local and stealable work.
+    if (join_hook) join_hook(true);
+    while (busy_workers.load(memory_order_acquire) != 0)
+    {
+        this_thread::yield();
+    }
+    if (join_hook) join_hook(false);
+    job = nullptr;
+}
+
+double thread_pool::measure_dispatch_overhead_us(unsigned int iterations)
+{
+    const function<void(size_t, size_t)> empty_body = [](size_t, size_t) {};
+    iterations = std::max(1u, iterations);
+
+    auto start = chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        parallel_for(num_participants, 1, empty_body);
+    }
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, micro>(end - start).count() / iterations;
+}
+
+void thread_pool::worker_loop(unsigned int id)
+{
+    if (id < participant_cpus.size())
+    {
+        cpu_topology::pin_current_thread(participant_cpus[id]);
+    }
+
+    uint64_t seen = 0;
+    while (true)
+    {
+        for (unsigned int spin = 0; spin < SPIN_ITERATIONS; ++spin)
+        {
+            if (generation.load(memory_order_acquire) != seen || stopping.load(memory_order_acquire)) break;
+            this_thread::yield();
+        }
+        {
+            unique_lock<mutex> lock(wake_mutex);
+            wake.wait(lock, [&]
+            {
+                return generation.load(memory_order_acquire) != seen || stopping.load(memory_order_acquire);
+            });
+        }
+        if (stopping.load(memory_order_acquire)) return;
+
+        seen = generation.load(memory_order_acquire);
+        run_chunks(id);
+        busy_workers.fetch_sub(1, memory_order_release);
+    }
+}
+
+void thread_pool::run_chunks(unsigned int id)
+{
+    uint32_t chunk;
+    while (pop_local(id, chunk) || steal(id, chunk))
+    {
+        const size_t begin = size_t(chunk) * job_grain;
+        (*job)(begin, std::min(begin + job_grain, job_count));
+    }
+}
+
+bool thread_pool::pop_local(unsigned int id, uint32_t& chunk)
+{
+    atomic<uint64_t>& bounds = ranges[id].bounds;
+    uint64_t current = bounds.load(memory_order_acquire);
+    while (range_lo(current) < range_hi(current))
+    {
+        if (bounds.compare_exchange_weak(current, pack(range_lo(current) + 1, range_hi(current)),
+                                         memory_order_acq_rel))
+        {
+            chunk = range_lo(current);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool thread_pool::steal(unsigned int id, uint32_t& chunk)
+{
+    for (unsigned int offset = 1; offset < num_participants; ++offset)
+    {
+        atomic<uint64_t>& victim = ranges[(id + offset) % num_participants].bounds;
+        uint64_t current = victim.load(memory_order_acquire);
+        while (range_lo(current) < range_hi(current))
+        {
+            const uint32_t lo = range_lo(current);
+            const uint32_t hi = range_hi(current);
+            const uint32_t stolen = (hi - lo + 1) / 2;
+            if (victim.compare_exchange_weak(current, pack(lo, hi - stolen), memory_order_acq_rel))
+            {
+                // Run the first stolen chunk now and publish the rest as our own share.
+                // Our slot is empty here, and nobody else writes to an empty slot.
+                chunk = hi - stolen;
+                ranges[id].bounds.store(pack(hi - stolen + 1, hi), memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Long-lived pool for fork-join loops. The calling thread takes part as participant 0,
+// so a pool of size P starts P - 1 workers. Between jobs the workers spin briefly and
+// then park on a condition variable, so back-to-back stages do not pay for a wake-up.
+// Each job is cut into chunks; every participant starts on its own contiguous share
+// and, once that is drained, steals the upper half of another participant's share.
+// With a CPU list (see cpu_topology::placement) participant i is pinned to cpus[i]; that
+// includes the calling thread, which stays pinned after the pool is gone.
+class thread_pool {
+public:
+    explicit thread_pool(unsigned int num_threads, const vector<int>& cpus = {});
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    unsigned int size() const { return num_participants; }
+    // CPU of every participant, empty when the pool is not pinned
+    const vector<int>& cpus() const { return participant_cpus; }
+
+    // Calls body(begin, end) over [0, count) in chunks of at most `grain` items and
+    // returns once every chunk has run. A single-chunk job runs inline without waking anyone.
+    void parallel_for(size_t count, size_t grain, const function<void(size_t, size_t)>& body);
+
+    // Called on the calling thread with true right before it waits for the workers to finish a
+    // job and with false once they have, so a profiler can attribute the join. Empty by default.
+    void set_join_hook(function<void(bool)> hook) { join_hook = move(hook); }
+
+    // Number of parallel_for calls that actually woke the workers
+    uint64_t dispatch_count() const { return dispatches; }
+
+    // Average wall time of an empty job split across every participant, in microseconds:
+    // the per-call cost of waking, distributing and joining.
+    double measure_dispatch_overhead_us(unsigned int iterations = 1000);
+
+private:
+    // [lo, hi) chunk range packed as (lo << 32) | hi so owner and thieves race on one CAS
+    struct alignas(64) chunk_range
+    {
+        atomic<uint64_t> bounds{0};
+    };
+
+    void worker_loop(unsigned int id);
+    void run_chunks(unsigned int id);
+    bool pop_local(unsigned int id, uint32_t& chunk);
+    bool steal(unsigned int id, uint32_t& chunk);
+
+    unsigned int num_participants;
+    vector<int> participant_cpus;
+    vector<thread> workers;
+    unique_ptr<chunk_range[]> ranges;
+
+    const function<void(size_t, size_t)>* job = nullptr;
+    size_t job_count = 0;
+    size_t job_grain = 1;
+    atomic<unsigned int> busy_workers{0};
+    uint64_t dispatches = 0;
+    function<void(bool)> join_hook;
+
+    mutex wake_mutex;
+    condition_variable wake;
+    atomic<uint64_t> generation{0};
+    atomic<bool> stopping{false};
+};
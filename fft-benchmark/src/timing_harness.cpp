@@ -0,0 +1,131 @@
+#include "timing_harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <sys/resource.h>
+
+timing_stats timing_harness::measure(const function<void()>& setup, const function<void()>& run) const
+{
+    const auto budget_start = chrono::high_resolution_clock::now();
+    auto elapsed_seconds = [&]
+    {
+        return chrono::duration<double>(chrono::high_resolution_clock::now() - budget_start).count();
+    };
+
+    // 1. Warmup: caches, TLB, page tables and the branch predictors settle
+    for (unsigned int i = 0; i < options.warmup_runs && elapsed_seconds() < options.max_seconds / 4; ++i)
+    {
+        setup();
+        run();
+    }
+
+    // 2. Batch size from one calibration run
+    timing_stats stats;
+    setup();
+    auto calibration_start = chrono::high_resolution_clock::now();
+    run();
+    const double single_ms =
+        chrono::duration<double, milli>(chrono::high_resolution_clock::now() - calibration_start).count();
+    if (single_ms < MIN_SAMPLE_MS)
+    {
+        stats.runs_per_sample = min(MAX_RUNS_PER_SAMPLE, size_t(ceil(MIN_SAMPLE_MS / max(single_ms, 1e-6))));
+    }
+
+    // 3. Timed repetitions with a running mean and variance (Welford)
+    vector<double> samples;
+    double mean = 0.0;
+    double m2 = 0.0;
+    uint64_t faults = 0;
+    // Lowest setup-only interval so far; a setup interval that was preempted can only be longer
+    double setup_floor_ms = numeric_limits<double>::infinity();
+    while (samples.size() < max(options.max_repetitions, 1u))
+    {
+        double ms = 0.0;
+        if (stats.runs_per_sample == 1)
+        {
+            setup();
+            const uint64_t faults_before = page_fault_count();
+            auto start = chrono::high_resolution_clock::now();
+            run();
+            auto end = chrono::high_resolution_clock::now();
+            faults += page_fault_count() - faults_before;
+            ms = chrono::duration<double, milli>(end - start).count();
+        }
+        else
+        {
+            // A run too short for the clock is never timed on its own. The batch's setups are
+            // timed as one interval, then setup() and run() alternately as another, so an
+            // in-place operation never runs on its own output; the lowest setup interval so far
+            // is taken off the second, and this batch's setup page faults likewise
+            const uint64_t faults_before = page_fault_count();
+            auto setup_start = chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < stats.runs_per_sample; ++i)
+            {
+                setup();
+            }
+            auto batch_start = chrono::high_resolution_clock::now();
+            const uint64_t faults_setup = page_fault_count();
+            for (size_t i = 0; i < stats.runs_per_sample; ++i)
+            {
+                setup();
+                run();
+            }
+            auto batch_end = chrono::high_resolution_clock::now();
+            const uint64_t faults_batch = page_fault_count();
+            setup_floor_ms = min(setup_floor_ms, chrono::duration<double, milli>(batch_start - setup_start).count());
+            const double batch_ms = chrono::duration<double, milli>(batch_end - batch_start).count();
+            ms = max(0.0, batch_ms - setup_floor_ms) / double(stats.runs_per_sample);
+            const uint64_t setup_faults = faults_setup - faults_before;
+            const uint64_t batch_faults = faults_batch - faults_setup;
+            faults += batch_faults - min(batch_faults, setup_faults);
+        }
+
+        samples.push_back(ms);
+        const double delta = ms - mean;
+        mean += delta / double(samples.size());
+        m2 += delta * (ms - mean);
+
+        if (samples.size() < max(options.min_repetitions, 2u))
+        {
+            continue;
+        }
+        const double stddev = sqrt(m2 / double(samples.size() - 1));
+        stats.relative_ci = mean > 0.0 ? 1.96 * stddev / sqrt(double(samples.size())) / mean : 0.0;
+        if (stats.relative_ci <= options.target_relative_ci || elapsed_seconds() >= options.max_seconds)
+        {
+            break;
+        }
+    }
+
+    // 4. Order statistics
+    sort(samples.begin(), samples.end());
+    const size_t count = samples.size();
+    stats.repetitions = count;
+    stats.min_ms = samples.front();
+    stats.median_ms = count % 2 == 1 ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+    stats.p99_ms = samples[size_t(ceil(0.99 * double(count))) - 1];
+    stats.mean_ms = mean;
+    stats.stddev_ms = count > 1 ? sqrt(m2 / double(count - 1)) : 0.0;
+    stats.page_faults = double(faults) / double(count * stats.runs_per_sample);
+    return stats;
+}
+
+uint64_t timing_harness::page_fault_count()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return uint64_t(usage.ru_minflt) + uint64_t(usage.ru_majflt);
+}
+
+double timing_harness::gflops(size_t n, double time_ms)
+{
+    if (n < 2 || time_ms <= 0.0)
+    {
+        return 0.0;
+    }
+    return 5.0 * double(n) * log2(double(n)) / (time_ms * 1e6);
+}
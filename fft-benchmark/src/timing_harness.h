@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+using namespace std;
+
+struct harness_options
+{
+    unsigned int warmup_runs = 2;
+    unsigned int min_repetitions = 3;
+    unsigned int max_repetitions = 1000;
+    // Stop once the 95% confidence half-width of the mean is within this fraction of the mean
+    double target_relative_ci = 0.01;
+    // Wall-time budget per measurement; warmups stop early and repetitions stop at the
+    // minimum once it is spent, so the largest sizes still finish
+    double max_seconds = 2.0;
+};
+
+struct timing_stats
+{
+    size_t repetitions = 0;
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+    double p99_ms = 0.0;
+    double mean_ms = 0.0;
+    double stddev_ms = 0.0;
+    double relative_ci = 0.0; // 95% half-width / mean, normal approximation
+    size_t runs_per_sample = 1;
+    double page_faults = 0.0; // minor + major faults per run, over the timed samples
+};
+
+// Repeated timing of one operation: untimed warmup runs, then timed repetitions until the
+// mean is known to the target confidence, the repetition cap is hit or the time budget
+// is spent. setup() runs untimed before every run, e.g. to restore an in-place input.
+// Runs shorter than MIN_SAMPLE_MS are timed in batches so the clock resolution does not
+// dominate: one interval over the batch's setup() and run() calls, less the shortest interval
+// seen over the same number of setup() calls alone. Each sample is the batch's mean per run.
+// On return the state left by run() is that of a single run after setup().
+class timing_harness {
+public:
+    explicit timing_harness(harness_options harness_options = {}) : options(harness_options) {}
+
+    timing_stats measure(const function<void()>& setup, const function<void()>& run) const;
+
+    // Nominal radix-2 operation count 5 N log2 N over the given time, in GFLOP/s
+    static double gflops(size_t n, double time_ms);
+
+    // Minor plus major page faults of the process so far (getrusage)
+    static uint64_t page_fault_count();
+
+    const harness_options& settings() const { return options; }
+
+private:
+    static constexpr double MIN_SAMPLE_MS = 0.05;
+    static constexpr size_t MAX_RUNS_PER_SAMPLE = 1024;
+
+    harness_options options;
+};
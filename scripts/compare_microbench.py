@@ -0,0 +1,160 @@
+import argparse
+import csv
+import math
+import sys
+
+
+def read_results(path):
+    """
+    Reads a fft_microbench CSV: '# key: value' header lines, then one row per benchmark.
+    Returns (metadata dict, {benchmark name: row dict}). A name that appears twice is an
+    error, since only one of the rows could be compared.
+    """
+    metadata = {}
+    rows = {}
+    with open(path, newline="") as f:
+        lines = []
+        for line in f:
+            if line.startswith("#"):
+                key, _, value = line[1:].partition(":")
+                metadata[key.strip()] = value.strip()
+            elif line.strip():
+                lines.append(line)
+    for row in csv.DictReader(lines):
+        if row["Benchmark"] in rows:
+            raise ValueError(f"{path}: duplicate benchmark '{row['Benchmark']}'")
+        rows[row["Benchmark"]] = {
+            "n": int(row["Repetitions"]),
+            "mean": float(row["Mean_ms"]),
+            "stddev": float(row["Stddev_ms"]),
+            "median": float(row["Median_ms"]),
+        }
+    return metadata, rows
+
+
+def betacf(a, b, x):
+    """Continued fraction of the incomplete beta function (modified Lentz)."""
+    tiny = 1e-300
+    qab, qap, qam = a + b, a + 1.0, a - 1.0
+    c, d = 1.0, 1.0 - qab * x / qap
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    h = d
+    for m in range(1, 300):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + aa / c
+        c = c if abs(c) > tiny else tiny
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + aa / c
+        c = c if abs(c) > tiny else tiny
+        delta = d * c
+        h *= delta
+        if abs(delta - 1.0) < 1e-12:
+            break
+    return h
+
+
+def incomplete_beta(a, b, x):
+    """Regularized incomplete beta I_x(a, b)."""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    front = math.exp(
+        math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1.0 - x)
+    )
+    if x < (a + 1.0) / (a + b + 2.0):
+        return front * betacf(a, b, x) / a
+    return 1.0 - front * betacf(b, a, 1.0 - x) / b
+
+
+def welch_p_slower(base, current):
+    """
+    One-sided Welch's t-test on the per-sample means: the probability of a slowdown at least
+    this large if the current mean were really no higher than the baseline's.
+    """
+    if base["n"] < 2 or current["n"] < 2:
+        return 1.0
+    vb = base["stddev"] ** 2 / base["n"]
+    vc = current["stddev"] ** 2 / current["n"]
+    if vb + vc == 0.0:
+        return 0.0 if current["mean"] > base["mean"] else 1.0
+    t = (current["mean"] - base["mean"]) / math.sqrt(vb + vc)
+    df = (vb + vc) ** 2 / (vb**2 / (base["n"] - 1) + vc**2 / (current["n"] - 1))
+    # Two-sided tail of Student's t is I_{df/(df+t^2)}(df/2, 1/2); halve it for one side
+    tail = 0.5 * incomplete_beta(df / 2.0, 0.5, df / (df + t * t))
+    return tail if t > 0 else 1.0 - tail
+
+
+def compare(baseline_path, current_path, threshold, alpha):
+    base_meta, base_rows = read_results(baseline_path)
+    cur_meta, cur_rows = read_results(current_path)
+
+    for key in ("model", "threads", "isa"):
+        if base_meta.get(key) != cur_meta.get(key):
+            print(
+                f"Warning: {key} differs (baseline '{base_meta.get(key)}', current '{cur_meta.get(key)}'); "
+                "timings may not be comparable"
+            )
+
+    regressions = []
+    improvements = []
+    print(f"{'Benchmark':<44} {'Base ms':>11} {'Current ms':>11} {'Change':>8} {'p':>8}")
+    for name, current in cur_rows.items():
+        base = base_rows.get(name)
+        if base is None:
+            continue
+        change = current["mean"] / base["mean"] - 1.0 if base["mean"] > 0 else 0.0
+        p_slower = welch_p_slower(base, current)
+        p_faster = welch_p_slower(current, base)
+        mark = ""
+        if change > threshold and p_slower < alpha:
+            regressions.append(name)
+            mark = "  REGRESSION"
+        elif -change > threshold and p_faster < alpha:
+            improvements.append(name)
+            mark = "  faster"
+        p = p_slower if change >= 0 else p_faster
+        print(f"{name:<44} {base['mean']:>11.5g} {current['mean']:>11.5g} {change:>+8.1%} {p:>8.2g}{mark}")
+
+    missing = sorted(set(base_rows) - set(cur_rows))
+    added = sorted(set(cur_rows) - set(base_rows))
+    if missing:
+        print(f"\nNot in the current run ({len(missing)}): " + ", ".join(missing))
+    if added:
+        print(f"\nNot in the baseline ({len(added)}): " + ", ".join(added))
+
+    print(
+        f"\n{len(regressions)} regression(s), {len(improvements)} improvement(s) "
+        f"(more than {threshold:.0%} on the mean at p < {alpha})"
+    )
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Flags microbenchmarks that are significantly slower than a stored baseline."
+    )
+    parser.add_argument("baseline", help="baseline CSV from fft_microbench")
+    parser.add_argument("current", help="CSV of the run to check")
+    parser.add_argument(
+        "--threshold", type=float, default=0.05, help="smallest relative slowdown that counts (default 0.05)"
+    )
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level (default 0.01)")
+    args = parser.parse_args()
+
+    try:
+        regressions = compare(args.baseline, args.current, args.threshold, args.alpha)
+    except ValueError as error:
+        print(f"Error: {error}", file=sys.stderr)
+        sys.exit(2)
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -47,12 +47,18 @@ mkdir -p "$PERF_OUTPUT_ROOT_DIR"
 echo "Raw results for this run will be saved to: $RAW_OUTPUT_ROOT_DIR"
 echo "Perf results for this run will be saved to: $PERF_OUTPUT_ROOT_DIR"
 
-# Function to run a set of benchmarks for a given SMT state
+# Physical cores: one entry per distinct sibling list
+PHYSICAL_CORES=$(cat /sys/devices/system/cpu/cpu*/topology/thread_siblings_list | sort -u | wc -l)
+
+# Function to run a set of benchmarks for a given SMT state. The benchmark pins its own
+# threads: "compact" packs SMT siblings together, "physical" uses one thread per core,
+# so SMT does not have to be switched off in the kernel for the smt_off set.
 run_benchmark_set() {
     local SMT_STATE=$1
+    local AFFINITY=$2
     local CURRENT_NPROC=$(nproc)
     echo "----------------------------------------"
-    echo "Running benchmarks with SMT: $SMT_STATE (Available logical cores: $CURRENT_NPROC)"
+    echo "Running benchmarks with SMT: $SMT_STATE (--affinity $AFFINITY, $PHYSICAL_CORES physical cores, $CURRENT_NPROC logical)"
 
     # Single-threaded benchmark (always runs)
     echo "Running single-threaded benchmark..."
@@ -99,8 +105,8 @@ run_benchmark_set() {
                 NUM_THREADS=$NUM_CORES
             fi
 
-            if [ "$NUM_THREADS" -gt "$CURRENT_NPROC" ]; then
-                echo "--- Skipping $NUM_CORES cores ($NUM_THREADS threads requested > $CURRENT_NPROC available) ---"
+            if [ "$NUM_THREADS" -gt "$CURRENT_NPROC" ] || [ "$NUM_CORES" -gt "$PHYSICAL_CORES" ]; then
+                echo "--- Skipping $NUM_CORES cores ($NUM_THREADS threads on $PHYSICAL_CORES cores / $CURRENT_NPROC CPUs) ---"
                 continue
             fi
             echo "--- Running on $NUM_CORES cores ($NUM_THREADS threads) ---"
@@ -115,45 +121,8 @@ run_benchmark_set() {
             local RAW_FILE_MULTI="$RAW_OUTPUT_ROOT_DIR/${CPU_VENDOR}_multi_${NUM_CORES}cores_${SMT_STATE}.csv"
             local PERF_FILE_MULTI="$PERF_OUTPUT_ROOT_DIR/perf_${CPU_VENDOR}_multi_${NUM_CORES}cores_${SMT_STATE}.csv"
 
-            # Build CPU affinity list
-            local CPU_LIST
-            if [ "$SMT_STATE" == "smt_on" ]; then
-                # SMT ON: use consecutive CPUs 0,1,2,...
-                CPU_LIST="0-$((NUM_THREADS - 1))"
-            else
-                # SMT OFF: different topology depending on vendor
-                if [ "$CPU_VENDOR" == "intel" ]; then
-                    # Intel hybrid: P-cores at 0,2,4,6,8 (even), E-cores at 9,10,11,...
-                    # When SMT off, available CPUs are: 0,2,4,6,8,9,10,11,...
-                    local INTEL_CPUS=""
-                    local p_core_idx=0
-                    local e_core_idx=0
-                    for ((i = 0; i < NUM_THREADS; i++)); do
-                        [ -n "$INTEL_CPUS" ] && INTEL_CPUS+=","
-                        # First, use up to 4 P-cores (0, 2, 4, 6)
-                        if [ $p_core_idx -lt 4 ]; then
-                            INTEL_CPUS+="$((p_core_idx * 2))"
-                            ((++p_core_idx))
-                        # Then, use E-cores (8, 9, 10, 11, ...)
-                        else
-                            INTEL_CPUS+="$((8 + e_core_idx))"
-                            ((++e_core_idx))
-                        fi
-                    done
-                    CPU_LIST="$INTEL_CPUS"
-                else
-                    # AMD: only even CPUs are available (0,2,4,6,...)
-                    local EVEN_CPUS=""
-                    for ((i = 0; i < NUM_THREADS; i++)); do
-                        [ -n "$EVEN_CPUS" ] && EVEN_CPUS+=","
-                        EVEN_CPUS+="$((i * 2))"
-                    done
-                    CPU_LIST="$EVEN_CPUS"
-                fi
-            fi
-
             perf stat -e "$PERF_EVENTS" -o "$PERF_FILE_MULTI" -x, \
-                taskset -c "$CPU_LIST" "$EXECUTABLE_PATH" --mode multi --threads "$NUM_THREADS" --output-file "$RAW_FILE_MULTI"
+                "$EXECUTABLE_PATH" --mode multi --threads "$NUM_THREADS" --affinity "$AFFINITY" --output-file "$RAW_FILE_MULTI"
 
             if [ "$MPSTAT_ENABLED" = true ] && [ -n "$MPSTAT_PID" ]; then
                 echo "  -> Stopping mpstat (PID: $MPSTAT_PID)"
@@ -167,19 +136,11 @@ run_benchmark_set() {
     fi
 }
 
-# --- Run with SMT ON ---
-echo "Ensuring SMT is ON for benchmarks..."
-sudo sh -c "echo on > /sys/devices/system/cpu/smt/control"
-run_benchmark_set "smt_on"
-
-# --- Run with SMT OFF ---
-echo "Disabling SMT for benchmarks..."
-sudo sh -c "echo off > /sys/devices/system/cpu/smt/control"
-run_benchmark_set "smt_off"
+# --- Run with SMT ON (siblings packed together) ---
+run_benchmark_set "smt_on" "compact"
 
-# --- Re-enable SMT ---
-echo "Re-enabling SMT..."
-sudo sh -c "echo on > /sys/devices/system/cpu/smt/control"
+# --- Run with SMT OFF (one thread per physical core) ---
+run_benchmark_set "smt_off" "physical"
 
 # --- Run GPU Benchmark ---
 echo "----------------------------------------"